@@ -2,8 +2,11 @@
 #define BINARY_MESSAGE_H
 
 #include <Stream.h>
+#include <type_traits>
 #include <utility>
 #include "common.h"
+#include "Checksum.h"
+#include "MessagePool.h"
 
 /**
  * @namespace bpa
@@ -17,9 +20,13 @@ namespace bpa {
     enum StartByte {
         UNDEFINED          = 0x00, ///< Undefined start byte
         START_V1           = 0x30, ///< Start byte for version 1
+        FRAGMENT_V1        = 0x3B, ///< Start byte for a fragment of a version 1 message
+        COMPRESSED_V1      = 0x3C, ///< Start byte for a version 1 message with a compressed payload
+        GROUP_V1           = 0x3D, ///< Start byte for a version 1 message sent to several devices at once
         CONFIRM            = 0x41, ///< Confirm start byte
         INCORRECT_FORMAT   = 0x46, ///< Incorrect format start byte
         INCORRECT_CHECKSUM = 0x48, ///< Incorrect checksum start byte
+        ACKNOWLEDGE        = 0x4B, ///< Cumulative and selective acknowledgement start byte
         PING               = 0x50, ///< Ping start byte
         REJECTED           = 0x52, ///< Rejected start byte
         HANDSHAKE_INIT     = 0x2A, ///< Handshake init start byte
@@ -28,27 +35,170 @@ namespace bpa {
         DISCONNECT         = 0x7E, ///< Disconnect start byte
     };
 
+    /**
+     * @brief Bit set in the start byte of a version or control frame whose header carries a 16-bit message ID.
+     */
+    constexpr uint8_t EXTENDED_HEADER = 0x80;
+
     const char* startByteToString(StartByte start); ///< Helper function to convert a StartByte to a string
 
+    /**
+     * @namespace internal
+     * @brief Namespace containing the start byte classification table.
+     */
+    namespace internal {
+        /**
+         * @brief Layout of a start byte classification entry.
+         *
+         * Bits 0-1 hold the class of the byte, bit 2 is set for supported start bytes, bit 3 for extended headers and
+         * bits 4-5 hold the payload rule that applies to messages with this start byte.
+         */
+        enum StartByteTraits : uint8_t {
+            CLASS_NONE        = 0x00, ///< The byte does not belong to any class
+            CLASS_VERSION     = 0x01, ///< Data message of a specific protocol version
+            CLASS_CONTROL     = 0x02, ///< Control message (confirmation, errors, ping)
+            CLASS_HANDSHAKE   = 0x03, ///< Handshake message
+            CLASS_MASK        = 0x03, ///< Mask of the class bits
+            SUPPORTED         = 0x04, ///< The byte is a supported start byte
+            EXTENDED          = 0x08, ///< The header carries the high byte of the message ID after the size
+            PAYLOAD_EMPTY     = 0x00, ///< The payload should be empty
+            PAYLOAD_HANDSHAKE = 0x10, ///< The payload should contain 3, 5 or 6 bytes
+            PAYLOAD_REQUIRED  = 0x20, ///< The payload should contain at least 1 byte
+            PAYLOAD_FRAGMENT  = 0x30, ///< The payload should contain a fragment header and at least 1 byte
+            PAYLOAD_MASK      = 0x30, ///< Mask of the payload rule bits
+        };
+
+        /**
+         * @brief Computes the classification entry of a start byte.
+         */
+        constexpr uint8_t classifyStartByte(const uint8_t start) {
+            if (start & EXTENDED_HEADER) {
+                // Any supported version or control byte has an extended variant
+                const auto traits = classifyStartByte(start & ~EXTENDED_HEADER);
+                const auto cls    = traits & CLASS_MASK;
+                return (cls == CLASS_VERSION || cls == CLASS_CONTROL) && (traits & SUPPORTED) ? traits | EXTENDED
+                                                                                                : CLASS_NONE;
+            }
+
+            uint8_t traits = CLASS_NONE;
+            if ((start >= START_V1 && start <= 0x39) || start == FRAGMENT_V1 || start == COMPRESSED_V1 ||
+                start == GROUP_V1) {
+                traits = CLASS_VERSION;
+            }
+            else if (start >= 0x41 && start <= 0x5A) {
+                traits = CLASS_CONTROL;
+            }
+            else if (start == HANDSHAKE_INIT || start == HANDSHAKE_RESP || start == HANDSHAKE_COMPLETE) {
+                traits = CLASS_HANDSHAKE | PAYLOAD_HANDSHAKE;
+            }
+
+            switch (start) {
+                case START_V1:
+                case COMPRESSED_V1:
+                case GROUP_V1:
+                    return traits | SUPPORTED | PAYLOAD_REQUIRED;
+                case FRAGMENT_V1:
+                    return traits | SUPPORTED | PAYLOAD_FRAGMENT;
+                case ACKNOWLEDGE:
+                    return traits | SUPPORTED | PAYLOAD_REQUIRED;
+                case CONFIRM:
+                case INCORRECT_FORMAT:
+                case INCORRECT_CHECKSUM:
+                case PING:
+                case REJECTED:
+                case HANDSHAKE_INIT:
+                case HANDSHAKE_RESP:
+                case HANDSHAKE_COMPLETE:
+                case DISCONNECT:
+                    return traits | SUPPORTED;
+                default:
+                    return traits;
+            }
+        }
+
+        /**
+         * @brief Lookup table with the classification entry of every byte value.
+         */
+        struct StartByteTable {
+            uint8_t traits[256];
+
+            constexpr StartByteTable() : traits() {
+                for (int i = 0; i < 256; i++) {
+                    traits[i] = classifyStartByte(static_cast<uint8_t>(i));
+                }
+            }
+        };
+
+        /**
+         * @brief Classification of all start bytes. It takes 256 bytes of RAM on purpose: it is read for every frame,
+         * and the start byte checks stay constexpr, which they could not with reads from PROGMEM.
+         */
+        inline constexpr StartByteTable START_BYTE_TABLE{};
+
+        /**
+         * @brief Gets the classification entry of a start byte.
+         */
+        constexpr uint8_t startByteTraits(const uint8_t start) {
+            return START_BYTE_TABLE.traits[start];
+        }
+    } // namespace internal
+
     /**
      * @brief Checks if the specified byte is a data byte for a specific version.
      */
-    bool isVersionStartByte(uint8_t start);
+    constexpr bool isVersionStartByte(const uint8_t start) {
+        return (internal::startByteTraits(start) & internal::CLASS_MASK) == internal::CLASS_VERSION;
+    }
 
     /**
      * @brief Checks if the specified byte is a control byte.
      */
-    bool isControlStartByte(uint8_t start);
+    constexpr bool isControlStartByte(const uint8_t start) {
+        return (internal::startByteTraits(start) & internal::CLASS_MASK) == internal::CLASS_CONTROL;
+    }
 
     /**
      * @brief Checks if the specified byte is a handshake byte.
      */
-    bool isHandshakeStartByte(uint8_t start);
+    constexpr bool isHandshakeStartByte(const uint8_t start) {
+        return (internal::startByteTraits(start) & internal::CLASS_MASK) == internal::CLASS_HANDSHAKE;
+    }
 
     /**
      * @brief Checks if the specified byte is a supported start byte.
      */
-    bool isSupportedStartByte(uint8_t start);
+    constexpr bool isSupportedStartByte(const uint8_t start) {
+        return internal::startByteTraits(start) & internal::SUPPORTED;
+    }
+
+    /**
+     * @brief Checks if the specified byte is a supported start byte of a frame with an extended header.
+     */
+    constexpr bool isExtendedStartByte(const uint8_t start) {
+        return internal::startByteTraits(start) & internal::EXTENDED;
+    }
+
+    /**
+     * @brief Gets the start byte of the frame without the extended header, e.g. START_V1 for an extended START_V1.
+     */
+    constexpr StartByte basicStartByte(const uint8_t start) {
+        return static_cast<StartByte>(isExtendedStartByte(start) ? start & ~EXTENDED_HEADER : start);
+    }
+
+    /**
+     * @brief Gets the start byte of the frame with an extended header, the start byte should be a version or control
+     * byte.
+     */
+    constexpr StartByte extendedStartByte(const StartByte start) {
+        return static_cast<StartByte>(start | EXTENDED_HEADER);
+    }
+
+    /**
+     * @brief Gets the length of the header of a frame, 5 bytes if it is extended and 4 bytes otherwise.
+     */
+    constexpr size_t headerLength(const uint8_t start) {
+        return isExtendedStartByte(start) ? 5 : 4;
+    }
 
     /**
      * @enum ValidationStatus
@@ -89,47 +239,408 @@ namespace bpa {
     bool isMessageEmpty(const BinaryMessage& message); ///< Helper function to check if a BinaryMessage is empty
 
     /**
-     * @class BinaryMessageIO
+     * @brief Validates a binary message.
+     * @param message The BinaryMessage to be validated.
+     * @return The validation status of the message.
+     */
+    ValidationStatus validateMessage(const BinaryMessage& message);
+
+    /**
+     * @brief Decodes the header of a frame stored in memory, four bytes or five if it is extended.
+     *
+     * Unsupported start bytes are decoded as UNDEFINED. The data pointer references the payload inside the frame
+     * (nullptr if the payload is empty), no payload is copied.
+     *
+     * @param frame Pointer to the first byte of the frame (start byte).
+     * @return The decoded BinaryMessage.
+     */
+    BinaryMessage decodeHeader(uint8_t* frame);
+
+    /**
+     * @brief Gets the length of a frame with the given payload size.
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    constexpr size_t frameLength(const uint8_t size) {
+        return size + 4 + TChecksum::SIZE;
+    }
+
+    /**
+     * @brief Gets the length of a frame with the given start byte and payload size.
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    constexpr size_t frameLength(const uint8_t start, const uint8_t size) {
+        return size + headerLength(start) + TChecksum::SIZE;
+    }
+
+    /**
+     * @brief Calculates the checksum of a frame: the header bytes followed by the payload.
+     *
+     * The same function is used by the reader and the writer, the payload is hashed in place.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     * @param message The message to calculate the checksum for.
+     * @return The checksum of the frame.
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    uint32_t frameChecksum(const BinaryMessage& message) {
+        TChecksum checksum;
+        checksum.update(message.start);
+        checksum.update(message.device_id);
+        checksum.update(lowByte(message.message_id));
+        checksum.update(message.size);
+        if (isExtendedStartByte(message.start)) {
+            checksum.update(highByte(message.message_id));
+        }
+        checksum.update(message.data, message.data == nullptr ? 0 : message.size);
+        return checksum.finalize();
+    }
+
+    /**
+     * @brief Decodes a complete frame stored in memory.
+     *
+     * The returned message references the frame memory, no payload is copied.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     * @param frame Pointer to the first byte of the frame (start byte).
+     * @param length The length of the frame, it should be equal to `frameLength<TChecksum>(frame[0], frame[3])`.
+     * @return A pair containing the decoded BinaryMessage and its validation status.
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    std::pair<BinaryMessage, ValidationStatus> decodeFrame(uint8_t* frame, size_t length);
+
+    /**
+     * @brief Encodes a message as a complete frame (header, payload and checksum) into caller-provided memory.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     * @param message The BinaryMessage to be encoded.
+     * @param frame Pointer to the memory receiving the frame.
+     * @param capacity The number of bytes available at `frame`.
+     * @return The length of the encoded frame, or 0 if the capacity is not enough.
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    size_t encodeFrame(const BinaryMessage& message, uint8_t* frame, size_t capacity);
+
+    namespace internal {
+        /**
+         * @brief Forwards the IO calls to the stream.
+         *
+         * Calls on a concrete stream type are qualified with the type, so they are bound at compile time and can be
+         * inlined. Calls on an abstract type (e.g. Stream) go through the virtual table.
+         *
+         * @tparam TStream The stream type.
+         */
+        template<typename TStream>
+        struct StreamCalls {
+            static constexpr bool STATIC = !std::is_abstract_v<TStream>; ///< The calls are bound at compile time
+
+            static size_t readBytes(TStream& stream, uint8_t* buffer, const size_t length) {
+                if constexpr (STATIC) {
+                    return stream.TStream::readBytes(reinterpret_cast<char *>(buffer), length);
+                }
+                else {
+                    return stream.readBytes(reinterpret_cast<char *>(buffer), length);
+                }
+            }
+
+            static size_t write(TStream& stream, const uint8_t* buffer, const size_t length) {
+                if constexpr (STATIC) {
+                    return stream.TStream::write(buffer, length);
+                }
+                else {
+                    return stream.write(buffer, length);
+                }
+            }
+        };
+    } // namespace internal
+
+    /**
+     * @class BasicBinaryMessageIO
      * @brief Class for reading, writing, and validating binary messages.
+     *
+     * The integrity policy is selected at compile time, so there is no runtime branch on the checksum type.
+     *
+     * The stream type is a template parameter as well. With the default `Stream` every read and write is a virtual
+     * call. Pass the concrete transport (e.g. `WiFiUDP` or `HardwareSerial`) to bind the calls at compile time, the
+     * object should then be exactly of that type. Any class with the `readBytes(char*, size_t)` and
+     * `write(const uint8_t*, size_t)` members can be used, e.g. a socket adapter on a host.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     * @tparam TStream The type of the stream used for reading and writing.
      */
-    class BinaryMessageIO {
+    template<typename TChecksum = Fnv1aHash16, typename TStream = Stream>
+    class BasicBinaryMessageIO {
     public:
+        static constexpr size_t MAX_FRAME_SIZE = BPA_MAX_PAYLOAD_SIZE + 4 + TChecksum::SIZE; ///< The maximum frame size
+
         /**
          * @brief Default constructor.
          * @param stream The stream to be used for reading and writing.
          */
-        explicit BinaryMessageIO(Stream& stream) : stream(&stream) {
+        explicit BasicBinaryMessageIO(TStream& stream) : stream(&stream) {
         }
 
         /**
          * @brief Destructor.
          */
-        ~BinaryMessageIO() = default;
+        ~BasicBinaryMessageIO() = default;
 
         /**
          * @brief Reads a binary message from the stream.
+         *
+         * The header is read first and then exactly the payload and the checksum, so the call returns as soon as the
+         * frame is complete. The stream timeout only applies if the frame is truncated.
+         *
          * @return A pair containing the read BinaryMessage and its validation status.
          */
         std::pair<BinaryMessage, ValidationStatus> read();
 
+        /**
+         * @brief Reads a binary message of a known length from the stream (e.g. a datagram size from UDP::parsePacket()).
+         *
+         * Only the given number of bytes is requested from the stream, so the call never waits for the stream timeout.
+         * A frame whose declared size does not match the length is reported as STATUS_UNEXPECTED_END_OF_STREAM.
+         *
+         * @param length The number of bytes available for the message.
+         * @return A pair containing the read BinaryMessage and its validation status.
+         */
+        std::pair<BinaryMessage, ValidationStatus> read(size_t length);
+
+        /**
+         * @brief Reads a binary message from the stream straight into a pool slot (see read()).
+         *
+         * The returned message points into the slot and stays valid as long as the handle, which can be moved into a
+         * queue without copying the payload. The handle views the payload of the message.
+         *
+         * @param handle A handle acquired from a MessagePool, its slot should hold MAX_FRAME_SIZE bytes.
+         * @return A pair containing the read BinaryMessage and its validation status.
+         */
+        std::pair<BinaryMessage, ValidationStatus> read(MessageHandle& handle);
+
+        /**
+         * @brief Reads a binary message of a known length from the stream straight into a pool slot (see read(size_t)
+         * and read(MessageHandle&)).
+         *
+         * @param handle A handle acquired from a MessagePool, its slot should hold MAX_FRAME_SIZE bytes.
+         * @param length The number of bytes available for the message.
+         * @return A pair containing the read BinaryMessage and its validation status.
+         */
+        std::pair<BinaryMessage, ValidationStatus> read(MessageHandle& handle, size_t length);
+
         /**
          * @brief Writes a binary message to the stream.
+         *
+         * The frame is assembled in an internal buffer and passed to the stream with a single write call.
+         *
          * @param message The BinaryMessage to be written.
+         * @return The number of bytes written to the stream.
          */
-        void write(const BinaryMessage& message) const;
+        size_t write(const BinaryMessage& message);
 
         /**
          * @brief Validates a binary message.
          * @param message The BinaryMessage to be validated.
          * @return The validation status of the message.
          */
-        static ValidationStatus validate(const BinaryMessage& message);
+        static ValidationStatus validate(const BinaryMessage& message) { return validateMessage(message); }
 
     private:
-        Stream* stream;                                    ///< Pointer to the stream used for reading and writing
-        static StartByte identify_start_byte(uint8_t val); ///< Helper function to read the start byte from the stream
-        uint8_t buffer[BPA_MAX_SIZE]{};                    ///< Buffer for reading the message data
+        using Calls = internal::StreamCalls<TStream>; ///< Calls to the stream
+
+        TStream* stream;                  ///< Pointer to the stream used for reading and writing
+        uint8_t buffer[MAX_FRAME_SIZE]{}; ///< Buffer for reading the message data
+        uint8_t frame[MAX_FRAME_SIZE]{};  ///< Buffer for assembling the written frame
+
+        /**
+         * @brief Reads the header and then the rest of a frame into the given memory.
+         */
+        std::pair<BinaryMessage, ValidationStatus> readFrame(uint8_t* into);
+
+        /**
+         * @brief Reads a frame of a known length into the given memory.
+         */
+        std::pair<BinaryMessage, ValidationStatus> readFrame(uint8_t* into, size_t length);
+
+        /**
+         * @brief Points the handle to the payload of the message read into its slot.
+         */
+        static std::pair<BinaryMessage, ValidationStatus> bind(MessageHandle& handle,
+                                                               std::pair<BinaryMessage, ValidationStatus> result);
     };
+
+    /**
+     * @brief Reads and writes frames protected with the default FNV-1a checksum.
+     */
+    using BinaryMessageIO = BasicBinaryMessageIO<>;
+
+    /**
+     * @brief Reads and writes frames protected with the default FNV-1a checksum on a concrete stream type.
+     */
+    template<typename TStream>
+    using StreamBinaryMessageIO = BasicBinaryMessageIO<Fnv1aHash16, TStream>;
+
+    template<typename TChecksum>
+    std::pair<BinaryMessage, ValidationStatus> decodeFrame(uint8_t* frame, const size_t length) {
+        const BinaryMessage message = decodeHeader(frame);
+
+        uint32_t checksum = 0;
+        for (size_t i = length - TChecksum::SIZE; i < length; i++) {
+            checksum = checksum << 8 | frame[i];
+        }
+
+        ValidationStatus status           = validateMessage(message);
+        const uint32_t calculatedChecksum = frameChecksum<TChecksum>(message);
+        status = status == STATUS_OK && checksum != calculatedChecksum ? STATUS_INCORRECT_CHECKSUM : status;
+
+#if defined(BPA_DEBUG_ENABLED)
+        DEBUG_PRINTF("decodeFrame() - Decoded message: start=0x%02X, device_id=%d, message_id=%d, size=%d, data=",
+                     message.start, message.device_id, message.message_id, message.size);
+        for (size_t i = 0; i < message.size; i++) {
+            DEBUG_PRINTF("%02X", message.data[i]);
+        }
+        DEBUG_PRINTLN();
+        DEBUG_PRINT("Validation status: ");
+        DEBUG_PRINTLN(validationStatusToString(status));
+        DEBUG_PRINTF("Checksum: 0x%08X, Calculated: 0x%08X\n", checksum, calculatedChecksum);
+#endif
+
+        return {message, status};
+    }
+
+    template<typename TChecksum>
+    size_t encodeFrame(const BinaryMessage& message, uint8_t* frame, const size_t capacity) {
+        const size_t length = frameLength<TChecksum>(message.start, message.size);
+        if (capacity < length) {
+            DEBUG_PRINTF("encodeFrame() - Not enough space for the frame: %d, required: %d\n", capacity, length);
+            return 0;
+        }
+
+        const auto header = headerLength(message.start);
+        frame[0]          = message.start;
+        frame[1]          = message.device_id;
+        frame[2]          = lowByte(message.message_id);
+        frame[3]          = message.size;
+        if (header > 4) {
+            frame[4] = highByte(message.message_id);
+        }
+        if (message.size > 0) {
+            memcpy(frame + header, message.data, message.size);
+        }
+
+        auto checksum = frameChecksum<TChecksum>(message);
+        for (size_t i = length; i > length - TChecksum::SIZE; i--) {
+            frame[i - 1] = checksum & 0xFF;
+            checksum >>= 8;
+        }
+        return length;
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::read() {
+        return readFrame(buffer);
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::read(const size_t length) {
+        return readFrame(buffer, length);
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::read(MessageHandle& handle) {
+        if (handle.capacity() < MAX_FRAME_SIZE) {
+            DEBUG_PRINTLN("BinaryMessageIO::read() - The message slot is too small");
+            return {emptyMessage(), STATUS_STREAM_ERROR};
+        }
+        return bind(handle, readFrame(handle.storage()));
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::read(MessageHandle& handle,
+                                                                                            const size_t length) {
+        if (handle.capacity() < MAX_FRAME_SIZE) {
+            DEBUG_PRINTLN("BinaryMessageIO::read() - The message slot is too small");
+            return {emptyMessage(), STATUS_STREAM_ERROR};
+        }
+        return bind(handle, readFrame(handle.storage(), length));
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::bind(
+        MessageHandle& handle, std::pair<BinaryMessage, ValidationStatus> result) {
+        const auto& message = result.first;
+        handle.assign(message.device_id, headerLength(message.start), message.data == nullptr ? 0 : message.size);
+        return result;
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::readFrame(uint8_t* into) {
+        if (this->stream == nullptr) {
+            DEBUG_PRINTLN("Stream not initialized");
+            return {emptyMessage(), STATUS_STREAM_ERROR};
+        }
+
+        if (Calls::readBytes(*stream, into, 4) != 4) {
+            DEBUG_PRINTLN("BinaryMessageIO::read() - No data to read");
+            return {emptyMessage(), STATUS_UNEXPECTED_END_OF_STREAM};
+        }
+
+        const size_t remaining = frameLength<TChecksum>(into[0], into[3]) - 4;
+        const auto count       = Calls::readBytes(*stream, into + 4, remaining);
+        if (count != remaining) {
+            DEBUG_PRINTF("BinaryMessageIO::read() - Incorrect message size: %d, expected: %d\n", count + 4,
+                         remaining + 4);
+            return {emptyMessage(), STATUS_UNEXPECTED_END_OF_STREAM};
+        }
+
+        return decodeFrame<TChecksum>(into, remaining + 4);
+    }
+
+    template<typename TChecksum, typename TStream>
+    std::pair<BinaryMessage, ValidationStatus> BasicBinaryMessageIO<TChecksum, TStream>::readFrame(uint8_t* into,
+                                                                                                 const size_t length) {
+        if (this->stream == nullptr) {
+            DEBUG_PRINTLN("Stream not initialized");
+            return {emptyMessage(), STATUS_STREAM_ERROR};
+        }
+
+        if (length < frameLength<TChecksum>(0) || length > MAX_FRAME_SIZE) {
+            DEBUG_PRINTF("BinaryMessageIO::read() - Unsupported packet length: %d\n", length);
+            return {emptyMessage(), STATUS_UNEXPECTED_END_OF_STREAM};
+        }
+
+        const auto count = Calls::readBytes(*stream, into, length);
+        if (count != length || count != frameLength<TChecksum>(into[0], into[3])) {
+            DEBUG_PRINTF("BinaryMessageIO::read() - Incorrect message size: %d, expected: %d\n", count,
+                         frameLength<TChecksum>(into[0], into[3]));
+            return {emptyMessage(), STATUS_UNEXPECTED_END_OF_STREAM};
+        }
+
+        return decodeFrame<TChecksum>(into, count);
+    }
+
+    template<typename TChecksum, typename TStream>
+    size_t BasicBinaryMessageIO<TChecksum, TStream>::write(const BinaryMessage& message) {
+        if (this->stream == nullptr) {
+            DEBUG_PRINTLN("Stream not initialized");
+            return 0;
+        }
+
+        const auto length = encodeFrame<TChecksum>(message, frame, sizeof(frame));
+        const auto count  = Calls::write(*stream, frame, length);
+
+#if defined(BPA_DEBUG_ENABLED)
+        DEBUG_PRINTF(
+            "BinaryMessageIO::write() -  Wrote message: start=0x%02X, device_id=%d, message_id=%d, size=%d, data=",
+            message.start, message.device_id, message.message_id, message.size);
+        for (size_t i = 0; i < message.size; i++) {
+            DEBUG_PRINTF("%02X", message.data[i]);
+        }
+        DEBUG_PRINTLN();
+#endif
+
+        return count;
+    }
 } // namespace bpa
 
 #endif // BINARY_MESSAGE_H
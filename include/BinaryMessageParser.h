@@ -0,0 +1,264 @@
+#ifndef BPA_BINARY_MESSAGE_PARSER_H
+#define BPA_BINARY_MESSAGE_PARSER_H
+
+#include <Stream.h>
+#include "common.h"
+#include "BinaryMessage.h"
+#include "RingBuffer.h"
+
+namespace bpa {
+    /**
+     * @class BasicBinaryMessageParser
+     * @brief Resumable parser that assembles binary messages from a byte stream (e.g. a UART).
+     *
+     * Bytes can be pushed one at a time as they arrive. The parser skips everything until a supported start byte,
+     * rejects frames with an invalid header or checksum and then resynchronises on the next start byte found inside
+     * the rejected bytes, so a good frame following a corrupted one is not lost.
+     *
+     * Frames are assembled in a single internal buffer. The message returned by message() references that buffer and
+     * stays valid until the next call to push() or poll().
+     *
+     * Frames queued in a RingBufferStream are parsed in place: a frame which does not wrap around the end of the ring
+     * is handed out without copying and its bytes are released on the next call to poll(), only a wrapped frame is
+     * copied into the internal buffer.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    class BasicBinaryMessageParser {
+    public:
+        static constexpr size_t MAX_FRAME_SIZE = BPA_MAX_PAYLOAD_SIZE + 4 + TChecksum::SIZE; ///< The maximum frame size
+
+        /**
+         * @brief Default constructor.
+         */
+        BasicBinaryMessageParser() = default;
+
+        /**
+         * @brief Destructor.
+         */
+        ~BasicBinaryMessageParser() = default;
+
+        /**
+         * @brief Feeds a single byte into the parser.
+         * @param byte The received byte.
+         * @return True if a complete and valid message is available via message().
+         */
+        bool push(uint8_t byte);
+
+        /**
+         * @brief Consumes the bytes which are currently available in the stream. Never waits for more data.
+         *
+         * Reading stops as soon as a complete message is assembled, the rest of the bytes stay in the stream.
+         *
+         * @param stream The stream to read from.
+         * @return True if a complete and valid message is available via message().
+         */
+        bool poll(Stream& stream);
+
+        /**
+         * @brief Parses the frames queued in a ring buffer in place. Never waits for more data.
+         *
+         * Incomplete frames stay in the ring. The bytes of the returned message are released on the next call.
+         *
+         * @param ring The ring buffer to read from, filled e.g. by the UART receive interrupt.
+         * @return True if a complete and valid message is available via message().
+         */
+        template<size_t TCapacity>
+        bool poll(RingBufferStream<TCapacity>& ring);
+
+        /**
+         * @brief Gets the last assembled message.
+         * @return The last assembled message, or an empty message if none is available.
+         */
+        [[nodiscard]] const BinaryMessage& message() const { return current; }
+
+        /**
+         * @brief Drops all buffered bytes and the last assembled message.
+         */
+        void reset();
+
+        [[nodiscard]] size_t droppedBytes() const { return dropped; }   ///< Gets the number of bytes skipped while searching for a frame
+        [[nodiscard]] size_t rejectedFrames() const { return rejected; } ///< Gets the number of frames rejected by validation
+
+    private:
+        uint8_t buffer[MAX_FRAME_SIZE]{};                  ///< Buffer for assembling the frame
+        size_t head           = 0;                         ///< Offset of the first byte of the current frame
+        size_t count          = 0;                         ///< Number of bytes stored in the buffer
+        size_t dropped        = 0;                         ///< Number of skipped bytes
+        size_t rejected       = 0;                         ///< Number of rejected frames
+        size_t borrowed       = 0;                         ///< Number of ring bytes referenced by the current message
+        BinaryMessage current = {UNDEFINED, 0, 0, 0, nullptr}; ///< The last assembled message
+
+        /**
+         * @brief Moves the unprocessed bytes to the beginning of the buffer.
+         */
+        void compact();
+
+        /**
+         * @brief Tries to assemble a message from the buffered bytes.
+         * @return True if a complete and valid message was assembled.
+         */
+        bool scan();
+
+        /**
+         * @brief Skips the current frame start and moves to the next supported start byte in the buffer.
+         */
+        void resync();
+    };
+
+    /**
+     * @brief Parses frames protected with the default FNV-1a checksum.
+     */
+    using BinaryMessageParser = BasicBinaryMessageParser<>;
+
+    template<typename TChecksum>
+    bool BasicBinaryMessageParser<TChecksum>::push(const uint8_t byte) {
+        compact();
+        if (count == 0 && !isSupportedStartByte(byte)) {
+            dropped++;
+            return false;
+        }
+
+        buffer[count++] = byte;
+        return scan();
+    }
+
+    template<typename TChecksum>
+    bool BasicBinaryMessageParser<TChecksum>::poll(Stream& stream) {
+        compact();
+        if (scan()) {
+            return true;
+        }
+
+        while (stream.available() > 0) {
+            const auto byte = stream.read();
+            if (byte < 0) {
+                break;
+            }
+            if (push(static_cast<uint8_t>(byte))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename TChecksum>
+    template<size_t TCapacity>
+    bool BasicBinaryMessageParser<TChecksum>::poll(RingBufferStream<TCapacity>& ring) {
+        static_assert(TCapacity >= MAX_FRAME_SIZE, "The ring buffer should hold a complete frame");
+
+        compact();
+        ring.consume(borrowed);
+        borrowed = 0;
+        if (count > 0) {
+            return poll(static_cast<Stream&>(ring)); // Finish the frame started with push()
+        }
+
+        uint8_t header[5];
+        while (true) {
+            int start;
+            while ((start = ring.peek()) >= 0 && !isSupportedStartByte(static_cast<uint8_t>(start))) {
+                ring.consume(1);
+                dropped++;
+            }
+            if (start < 0 || ring.peekBytes(header, headerLength(start)) < headerLength(start)) {
+                return false;
+            }
+
+            if (validateMessage(decodeHeader(header)) == STATUS_OK) {
+                const size_t length = frameLength<TChecksum>(header[0], header[3]);
+                if (static_cast<size_t>(ring.available()) < length) {
+                    return false; // Wait for the rest of the frame
+                }
+
+                size_t contiguous;
+                uint8_t* frame     = ring.span(contiguous);
+                const bool inPlace = contiguous >= length;
+                if (!inPlace) {
+                    ring.peekBytes(buffer, length);
+                    frame = buffer;
+                }
+
+                if (const auto [message, status] = decodeFrame<TChecksum>(frame, length); status == STATUS_OK) {
+                    current = message;
+                    if (inPlace) {
+                        borrowed = length;
+                    }
+                    else {
+                        ring.consume(length);
+                    }
+                    return true;
+                }
+            }
+
+            DEBUG_PRINTF("BinaryMessageParser::poll() - Invalid frame (start: 0x%02X), resync\n", header[0]);
+            rejected++;
+            ring.consume(1);
+            dropped++;
+        }
+    }
+
+    template<typename TChecksum>
+    void BasicBinaryMessageParser<TChecksum>::reset() {
+        head    = 0;
+        count   = 0;
+        current = emptyMessage();
+    }
+
+    template<typename TChecksum>
+    void BasicBinaryMessageParser<TChecksum>::compact() {
+        current = emptyMessage();
+        if (head == 0) {
+            return;
+        }
+
+        count -= head;
+        memmove(buffer, buffer + head, count);
+        head = 0;
+    }
+
+    template<typename TChecksum>
+    bool BasicBinaryMessageParser<TChecksum>::scan() {
+        while (count - head >= 4) {
+            uint8_t* frame = buffer + head;
+            if (count - head < headerLength(frame[0])) {
+                return false; // Wait for the rest of the extended header
+            }
+            if (validateMessage(decodeHeader(frame)) != STATUS_OK) {
+                DEBUG_PRINTF("BinaryMessageParser::scan() - Invalid header (start: 0x%02X), resync\n", frame[0]);
+                rejected++;
+                resync();
+                continue;
+            }
+
+            const size_t length = frameLength<TChecksum>(frame[0], frame[3]);
+            if (count - head < length) {
+                return false; // Wait for the rest of the frame
+            }
+
+            if (const auto [message, status] = decodeFrame<TChecksum>(frame, length); status == STATUS_OK) {
+                current = message;
+                head += length;
+                return true;
+            }
+
+            DEBUG_PRINTF("BinaryMessageParser::scan() - Invalid frame (start: 0x%02X), resync\n", frame[0]);
+            rejected++;
+            resync();
+        }
+        return false;
+    }
+
+    template<typename TChecksum>
+    void BasicBinaryMessageParser<TChecksum>::resync() {
+        size_t next = head + 1;
+        while (next < count && !isSupportedStartByte(buffer[next])) {
+            next++;
+        }
+        dropped += next - head;
+        head = next;
+    }
+} // namespace bpa
+
+#endif // BPA_BINARY_MESSAGE_PARSER_H
@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "Errors.h"
+#include "MessagePool.h"
 
 /**
  * @brief This is a library skeleton with the namespace "bpa" and a virtual class.
@@ -25,6 +26,8 @@ namespace bpa {
         virtual uint8_t type() = 0;
     };
 
+    inline DeviceInfo::~DeviceInfo() = default;
+
     /**
      * @brief Represents a tunnel for communication between devices.
      *
@@ -40,7 +43,8 @@ namespace bpa {
          */
         explicit Tunnel(const DeviceID id) : id(id), onDeviceConnectedCallback(nullptr), onErrorCallback(nullptr),
                                              onDeviceDisconnectedCallback(nullptr),
-                                             onMessageReceivedCallback(nullptr) {
+                                             onMessageReceivedCallback(nullptr),
+                                             onMessageHandleReceivedCallback(nullptr) {
         };
 
         /**
@@ -51,11 +55,44 @@ namespace bpa {
         /**
          * @brief Sends a message to the specified recipient.
          *
+         * Messages larger than the payload of a single frame (255 bytes) are split into fragments and reassembled by
+         * the recipient, up to BPA_MAX_MESSAGE_SIZE bytes.
+         *
          * @param to The ID of the recipient.
          * @param buffer A pointer to the message buffer.
          * @param size The size of the message.
+         * @return SEND_OK if the message was accepted, SEND_WOULD_BLOCK if the recipient cannot take it now.
          */
-        virtual void sendMessage(DeviceID to, uint8_t* buffer, uint8_t size) = 0;
+        virtual SendResult sendMessage(DeviceID to, uint8_t* buffer, MessageSize size) = 0;
+
+        /**
+         * @brief Sends the same message to several recipients.
+         *
+         * Each recipient is handled as by sendMessage(), a recipient which cannot take the message does not prevent
+         * the others from getting it. Implementations can share the work done on the message between the recipients.
+         *
+         * @param to The IDs of the recipients.
+         * @param count The number of recipients.
+         * @param buffer A pointer to the message buffer.
+         * @param size The size of the message.
+         * @return The number of recipients which accepted the message.
+         */
+        virtual size_t sendToGroup(const DeviceID* to, const size_t count, uint8_t* buffer, const MessageSize size) {
+            size_t accepted = 0;
+            for (size_t i = 0; i < count; i++) {
+                accepted += sendMessage(to[i], buffer, size) == SEND_OK ? 1 : 0;
+            }
+            return accepted;
+        }
+
+        /**
+         * @brief Sends a message to all connected devices, see sendToGroup().
+         *
+         * @param buffer A pointer to the message buffer.
+         * @param size The size of the message.
+         * @return The number of devices which accepted the message.
+         */
+        virtual size_t broadcast(uint8_t* buffer, MessageSize size) = 0;
 
         /**
          * @brief The loop method is used to perform all necessary repeated actions to maintain communication.
@@ -127,13 +164,14 @@ namespace bpa {
          * @brief Sets the callback function for when a message is received.
          *
          * This function allows the user to set a callback function that will be called when a message is received.
-         * The callback function should have the following signature: void callback(DeviceID, uint8_t*, uint8_t).
+         * The callback function should have the following signature: void callback(DeviceID, uint8_t*, MessageSize).
          * The first parameter is the device ID of the sender, the second parameter is a pointer to the message data, and
-         * the third parameter is the length of the message data.
+         * the third parameter is the length of the message data. A fragmented message is delivered once, after all of
+         * its fragments were received.
          *
          * Example usage:
          * @code
-         * void handleMessage(DeviceID sender, uint8_t* data, uint8_t length)
+         * void handleMessage(DeviceID sender, uint8_t* data, MessageSize length)
          * {
          *     // Process the received message
          * }
@@ -143,9 +181,33 @@ namespace bpa {
          * @endcode
          *
          * @param callback A pointer to the callback function to be called when a message is received.
-         *                 The function should have the signature: void callback(DeviceID, uint8_t*, uint8_t).
+         *                 The function should have the signature: void callback(DeviceID, uint8_t*, MessageSize).
+         */
+        void onMessageReceived(void (*callback)(DeviceID, uint8_t*, MessageSize)) {
+            onMessageReceivedCallback = callback;
+        }
+
+        /**
+         * @brief Sets the callback function receiving messages as pooled handles.
+         *
+         * The payload is stored in a slot of the tunnel's MessagePool. Move the handle out of the callback to keep the
+         * message, e.g. into a queue processed later or by another task, no copy is needed. Otherwise the slot is
+         * released when the callback returns. When all slots are held, received messages are dropped with the
+         * MESSAGE_DROPPED error. With BPA_MESSAGE_POOL_SLOTS set to 0 every message is dropped this way.
+         *
+         * Example usage:
+         * @code
+         * MessageHandle pending;
+         *
+         * void handleMessage(MessageHandle& message)
+         * {
+         *     pending = std::move(message);
+         * }
+         * @endcode
+         *
+         * @param callback A pointer to the callback function to be called when a message is received.
          */
-        void onMessageReceived(void (*callback)(DeviceID, uint8_t*, uint8_t)) { onMessageReceivedCallback = callback; }
+        void onMessageReceived(void (*callback)(MessageHandle&)) { onMessageHandleReceivedCallback = callback; }
 
         /**
          * @brief Sets the callback function to handle error events.
@@ -178,12 +240,20 @@ namespace bpa {
             }
         }
 
-        void triggerMessageReceived(const DeviceID id, uint8_t* payload, const uint8_t size) const {
+        void triggerMessageReceived(const DeviceID id, uint8_t* payload, const MessageSize size) const {
             if (onMessageReceivedCallback) {
                 onMessageReceivedCallback(id, payload, size);
             }
         }
 
+        void triggerMessageReceived(MessageHandle& handle) const {
+            if (onMessageHandleReceivedCallback) {
+                onMessageHandleReceivedCallback(handle);
+            }
+        }
+
+        [[nodiscard]] bool hasMessageHandleCallback() const { return onMessageHandleReceivedCallback != nullptr; }
+
     private:
         DeviceID id; ///< The ID of the device
 
@@ -227,7 +297,7 @@ namespace bpa {
          *
          * This function pointer can be used to register a callback function that will be called when a message is received.
          * The callback function should have the following signature:
-         *   void callback(DeviceID deviceId, uint8_t* data, uint8_t length);
+         *   void callback(DeviceID deviceId, uint8_t* data, MessageSize length);
          * where:
          *   - deviceId: The ID of the device that received the message.
          *   - data: A pointer to the data of the received message.
@@ -237,7 +307,12 @@ namespace bpa {
          * @param data A pointer to the data of the received message.
          * @param length The length of the data.
          */
-        void (*onMessageReceivedCallback)(DeviceID, uint8_t*, uint8_t);
+        void (*onMessageReceivedCallback)(DeviceID, uint8_t*, MessageSize);
+
+        /**
+         * @brief Callback function receiving messages as pooled handles, see onMessageReceived(void (*)(MessageHandle&)).
+         */
+        void (*onMessageHandleReceivedCallback)(MessageHandle&);
     };
 }
 
@@ -0,0 +1,140 @@
+#ifndef BPA_CHECKSUM_H
+#define BPA_CHECKSUM_H
+
+#include "common.h"
+
+/**
+ * Integrity policies for the frame trailer.
+ *
+ * Every policy is an incremental hasher with the same interface, so it can be passed as a template parameter to
+ * BasicBinaryMessageIO and BasicBinaryMessageParser:
+ *  - `SIZE` - the number of trailer bytes written after the payload (big-endian);
+ *  - `reset()`, `update(byte)`, `update(bytes, length)` - feed the header and the payload;
+ *  - `finalize()` - returns the checksum value.
+ */
+namespace bpa {
+    /**
+     * @class Fnv1aHash16
+     * @brief Incremental 16-bit Fowler-Noll-Vo (FNV-1a) hash. This is the default frame checksum.
+     *
+     * The hash is fed in pieces, so the header and the payload can be hashed where they are stored without assembling
+     * them into a temporary buffer.
+     */
+    class Fnv1aHash16 {
+    public:
+        static constexpr uint8_t SIZE = 2; ///< The number of trailer bytes
+
+        /**
+         * @brief Creates a hasher initialized with the offset basis.
+         */
+        Fnv1aHash16() = default;
+
+        /**
+         * @brief Resets the hasher to the offset basis.
+         */
+        void reset() { hash = OFFSET_BASIS; }
+
+        /**
+         * @brief Adds a single byte to the hash.
+         * @param byte The byte to add.
+         */
+        void update(const uint8_t byte) {
+            hash ^= byte;
+            hash *= PRIME;
+        }
+
+        /**
+         * @brief Adds a sequence of bytes to the hash. The loop is unrolled to process four bytes per iteration.
+         * @param bytes Pointer to the bytes, may be nullptr if length is 0.
+         * @param length The number of bytes to add.
+         */
+        void update(const uint8_t* bytes, size_t length);
+
+        /**
+         * @brief Gets the resulting hash value.
+         * @return The hash of all bytes added since the last reset.
+         */
+        [[nodiscard]] uint16_t finalize() const { return hash; }
+
+    private:
+        static constexpr uint16_t OFFSET_BASIS = 0x97; ///< Initial hash value
+        static constexpr uint16_t PRIME        = 0xA1; ///< Multiplier applied after every byte
+
+        uint16_t hash = OFFSET_BASIS; ///< Current hash value
+    };
+
+    /**
+     * @class Crc16Ccitt
+     * @brief Table-driven CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+     *
+     * Detects all burst errors up to 16 bits, which makes it a better fit for noisy serial links. The lookup table
+     * takes 512 bytes of flash (PROGMEM) on Arduino targets.
+     */
+    class Crc16Ccitt {
+    public:
+        static constexpr uint8_t SIZE = 2; ///< The number of trailer bytes
+
+        void reset() { crc = INITIAL_VALUE; } ///< Resets the CRC to the initial value
+        void update(uint8_t byte);            ///< Adds a single byte to the CRC
+
+        /**
+         * @brief Adds a sequence of bytes to the CRC.
+         * @param bytes Pointer to the bytes, may be nullptr if length is 0.
+         * @param length The number of bytes to add.
+         */
+        void update(const uint8_t* bytes, size_t length);
+
+        [[nodiscard]] uint16_t finalize() const { return crc; } ///< Gets the resulting CRC value
+
+    private:
+        static constexpr uint16_t INITIAL_VALUE = 0xFFFF; ///< Initial CRC value
+
+        uint16_t crc = INITIAL_VALUE; ///< Current CRC value
+    };
+
+    /**
+     * @class Crc32
+     * @brief CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) computed with the slicing-by-8 algorithm.
+     *
+     * Processes eight bytes per iteration using 8 KB of lookup tables, so it is intended for hosts (e.g. a gateway)
+     * rather than for microcontrollers. On Arduino targets the tables are kept in flash (PROGMEM) rather than RAM, each
+     * lookup then reads the flash.
+     */
+    class Crc32 {
+    public:
+        static constexpr uint8_t SIZE = 4; ///< The number of trailer bytes
+
+        void reset() { crc = INITIAL_VALUE; } ///< Resets the CRC to the initial value
+        void update(uint8_t byte);            ///< Adds a single byte to the CRC
+
+        /**
+         * @brief Adds a sequence of bytes to the CRC, eight bytes per iteration.
+         * @param bytes Pointer to the bytes, may be nullptr if length is 0.
+         * @param length The number of bytes to add.
+         */
+        void update(const uint8_t* bytes, size_t length);
+
+        [[nodiscard]] uint32_t finalize() const { return ~crc; } ///< Gets the resulting CRC value
+
+    private:
+        static constexpr uint32_t INITIAL_VALUE = 0xFFFFFFFF; ///< Initial CRC value
+
+        uint32_t crc = INITIAL_VALUE; ///< Current CRC value (not inverted)
+    };
+
+    /**
+     * @class NoChecksum
+     * @brief Disables the frame trailer, for links which already verify the integrity (e.g. UDP over Ethernet).
+     */
+    class NoChecksum {
+    public:
+        static constexpr uint8_t SIZE = 0; ///< The number of trailer bytes
+
+        void reset() {}                                      ///< Does nothing
+        void update(uint8_t) {}                              ///< Does nothing
+        void update(const uint8_t*, size_t) {}               ///< Does nothing
+        [[nodiscard]] uint8_t finalize() const { return 0; } ///< Always returns 0
+    };
+} // namespace bpa
+
+#endif // BPA_CHECKSUM_H
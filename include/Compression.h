@@ -0,0 +1,44 @@
+#ifndef BPA_COMPRESSION_H
+#define BPA_COMPRESSION_H
+
+#include "common.h"
+
+/**
+ * Lightweight LZ77 codec for frame payloads.
+ *
+ * The format is byte-oriented LZSS: every group of up to eight items is preceded by a flag byte, bit `i` tells if
+ * item `i` is a literal byte (0) or a back-reference (1). A back-reference takes two bytes: the distance minus one
+ * (the window is 256 bytes) and the length minus LZ_MIN_MATCH.
+ *
+ * Neither function allocates memory, the compressor uses about 640 bytes of stack for its hash chains.
+ */
+namespace bpa {
+    constexpr size_t LZ_WINDOW_SIZE = 256; ///< The largest distance of a back-reference
+    constexpr size_t LZ_MIN_MATCH   = 3;   ///< The shortest back-reference
+    constexpr size_t LZ_MAX_MATCH   = 258; ///< The longest back-reference
+
+    /**
+     * @brief Compresses the input.
+     *
+     * @param input The bytes to compress.
+     * @param length The number of bytes to compress (at most 65535).
+     * @param output The memory receiving the compressed bytes.
+     * @param capacity The number of bytes available at `output`.
+     * @return The size of the compressed data, or 0 if it does not fit into the capacity. Pass `length - 1` as the
+     *         capacity to only accept a result smaller than the input.
+     */
+    size_t lzCompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity);
+
+    /**
+     * @brief Decompresses data produced by lzCompress().
+     *
+     * @param input The compressed bytes.
+     * @param length The number of compressed bytes.
+     * @param output The memory receiving the decompressed bytes.
+     * @param capacity The number of bytes available at `output`.
+     * @return The size of the decompressed data, or 0 if the input is malformed or does not fit into the capacity.
+     */
+    size_t lzDecompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity);
+} // namespace bpa
+
+#endif // BPA_COMPRESSION_H
@@ -0,0 +1,108 @@
+#ifndef BPA_DEVICE_TABLE_H
+#define BPA_DEVICE_TABLE_H
+
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @class DeviceTable
+     * @brief Fixed-capacity table of per-device records, indexed by device ID.
+     *
+     * Records are stored contiguously in a dense array, an index of 256 bytes maps every device ID to its slot. Lookups
+     * take constant time, iterating visits only the used slots and nothing is allocated on the heap. Removing a record
+     * moves the last record into its slot, so the order of the records is not preserved.
+     *
+     * @tparam TRecord The record kept for each device, copyable.
+     * @tparam TCapacity The maximum number of devices.
+     */
+    template<typename TRecord, size_t TCapacity>
+    class DeviceTable {
+    public:
+        static_assert(TCapacity > 0 && TCapacity < 256, "The capacity should be between 1 and 255");
+
+        /**
+         * @brief A used slot of the table.
+         */
+        struct Entry {
+            DeviceID id;    ///< The ID of the device
+            TRecord record; ///< The record of the device
+        };
+
+        /**
+         * @brief Creates an empty table.
+         */
+        DeviceTable() = default;
+
+        /**
+         * @brief Gets the record of a device.
+         * @param id The ID of the device.
+         * @return The record, or nullptr if the device is not in the table.
+         */
+        TRecord* find(const DeviceID id) {
+            const auto slot = slots[id];
+            return slot == 0 ? nullptr : &entries[slot - 1].record;
+        }
+
+        /**
+         * @brief Stores the record of a device, replacing the existing one.
+         * @param id The ID of the device.
+         * @param record The record of the device.
+         * @return The stored record, or nullptr if the device is new and the table is full.
+         */
+        TRecord* insert(const DeviceID id, const TRecord& record) {
+            auto slot = slots[id];
+            if (slot == 0) {
+                if (count == TCapacity) {
+                    return nullptr;
+                }
+                slot                 = static_cast<uint8_t>(++count);
+                slots[id]            = slot;
+                entries[slot - 1].id = id;
+            }
+            entries[slot - 1].record = record;
+            return &entries[slot - 1].record;
+        }
+
+        /**
+         * @brief Removes the record of a device.
+         * @param id The ID of the device.
+         * @return True if the device was in the table.
+         */
+        bool erase(const DeviceID id) {
+            const auto slot = slots[id];
+            if (slot == 0) {
+                return false;
+            }
+            eraseAt(slot - 1);
+            return true;
+        }
+
+        /**
+         * @brief Removes the record at the given position, the last record takes its place.
+         * @param index The position of the record, less than size().
+         */
+        void eraseAt(const size_t index) {
+            slots[entries[index].id] = 0;
+            count--;
+            if (index != count) {
+                entries[index]           = entries[count];
+                slots[entries[index].id] = static_cast<uint8_t>(index + 1);
+            }
+        }
+
+        Entry& operator[](const size_t index) { return entries[index]; } ///< Gets the record at the given position
+
+        [[nodiscard]] size_t size() const { return count; }            ///< Gets the number of records
+        [[nodiscard]] bool full() const { return count == TCapacity; } ///< Checks if no record can be added
+
+        Entry* begin() { return entries; }       ///< Gets the first used slot
+        Entry* end() { return entries + count; } ///< Gets the end of the used slots
+
+    private:
+        Entry entries[TCapacity]{}; ///< The used slots first, then the free ones
+        uint8_t slots[256]{};       ///< The position of the record of each device plus one, 0 if there is none
+        size_t count = 0;           ///< The number of used slots
+    };
+} // namespace bpa
+
+#endif // BPA_DEVICE_TABLE_H
@@ -8,9 +8,24 @@ enum ErrorCode {
     DEVICE_NOT_CONNECTED = 1,
     DEVICE_LOST = 2,
     INCORRECT_FORMAT_ERROR = 3,
+    MESSAGE_TOO_LARGE = 4,
+    MESSAGE_INCOMPLETE = 5,
+    MESSAGE_DROPPED = 6,
+    TOO_MANY_DEVICES = 7,
+    SEND_WINDOW_FULL = 8,
+    DELIVERY_FAILED = 9,
     
 };
 
+/**
+ * @brief The result of Tunnel::sendMessage().
+ */
+enum SendResult {
+    SEND_OK = 0,          ///< The message was sent or queued
+    SEND_WOULD_BLOCK = 1, ///< The recipient cannot take the message now, it can be sent again after the next loop()
+    SEND_FAILED = 2,      ///< The message cannot be sent, the error callback tells why
+};
+
 } // namespace bpa
 
 #endif // BPA_ERRORS_H
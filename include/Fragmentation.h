@@ -0,0 +1,279 @@
+#ifndef BPA_FRAGMENTATION_H
+#define BPA_FRAGMENTATION_H
+
+#include <string.h>
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @namespace internal
+     * @brief Namespace containing the layout of the fragment payload.
+     */
+    namespace internal {
+        constexpr uint8_t FRAGMENT_HEADER_SIZE = 3;                          ///< Transfer ID, fragment index, count
+        constexpr uint8_t FRAGMENT_CHUNK_SIZE  = 255 - FRAGMENT_HEADER_SIZE; ///< Message bytes carried by a fragment
+    } // namespace internal
+
+    /**
+     * @brief Gets the number of fragments needed to carry a message of the given size.
+     */
+    constexpr size_t fragmentCount(const size_t size) {
+        return (size + internal::FRAGMENT_CHUNK_SIZE - 1) / internal::FRAGMENT_CHUNK_SIZE;
+    }
+
+    /**
+     * @brief The largest message which can be fragmented (the fragment count is a single byte).
+     */
+    constexpr size_t MAX_FRAGMENTED_MESSAGE_SIZE = 255 * internal::FRAGMENT_CHUNK_SIZE;
+
+    /**
+     * @class Fragmenter
+     * @brief Splits a message into the payloads of FRAGMENT_V1 frames.
+     *
+     * Each payload starts with the fragment header (transfer ID, fragment index, fragment count) followed by up to
+     * FRAGMENT_CHUNK_SIZE bytes of the message. Every fragment but the last one carries a full chunk, so the receiver
+     * can place a fragment at `index * FRAGMENT_CHUNK_SIZE` whatever the order of arrival.
+     */
+    class Fragmenter {
+    public:
+        /**
+         * @brief Creates a fragmenter over the given message.
+         * @param transfer The ID shared by all fragments of the message.
+         * @param data Pointer to the message, it should stay valid while iterating.
+         * @param size The size of the message, at most MAX_FRAGMENTED_MESSAGE_SIZE.
+         */
+        Fragmenter(const uint8_t transfer, const uint8_t* data, const MessageSize size) : data(data), size(size),
+            count(static_cast<uint8_t>(fragmentCount(size))) {
+            buffer[0] = transfer;
+            buffer[2] = count;
+        }
+
+        /**
+         * @brief Prepares the payload of the next fragment.
+         * @return True if a fragment was prepared, false when the whole message was consumed.
+         */
+        bool next() {
+            if (index >= count) {
+                return false;
+            }
+
+            const size_t offset = index * internal::FRAGMENT_CHUNK_SIZE;
+            const size_t chunk  = size - offset < internal::FRAGMENT_CHUNK_SIZE
+                                     ? size - offset
+                                     : internal::FRAGMENT_CHUNK_SIZE;
+            buffer[1] = index;
+            memcpy(buffer + internal::FRAGMENT_HEADER_SIZE, data + offset, chunk);
+            length = static_cast<uint8_t>(internal::FRAGMENT_HEADER_SIZE + chunk);
+            index++;
+            return true;
+        }
+
+        [[nodiscard]] uint8_t* payload() { return buffer; }          ///< Gets the payload of the current fragment
+        [[nodiscard]] uint8_t payloadSize() const { return length; } ///< Gets the payload size of the current fragment
+        [[nodiscard]] uint8_t fragments() const { return count; }     ///< Gets the number of fragments of the message
+
+    private:
+        const uint8_t* data;   ///< The message being fragmented
+        MessageSize size;      ///< The size of the message
+        uint8_t count;         ///< The number of fragments
+        uint8_t index  = 0;    ///< The index of the next fragment
+        uint8_t length = 0;    ///< The payload size of the current fragment
+        uint8_t buffer[255]{}; ///< The payload of the current fragment
+    };
+
+    /**
+     * @enum ReassemblyStatus
+     * @brief Result of adding a fragment to a ReassemblyPool.
+     */
+    enum ReassemblyStatus {
+        REASSEMBLY_PENDING,   ///< The fragment was stored, the message is not complete yet
+        REASSEMBLY_COMPLETE,  ///< The fragment completed the message
+        REASSEMBLY_DUPLICATE, ///< The fragment was already received
+        REASSEMBLY_INVALID,   ///< The fragment header is inconsistent
+        REASSEMBLY_TOO_LARGE, ///< The message does not fit into a reassembly buffer
+        REASSEMBLY_NO_SLOT,   ///< All reassembly buffers are in use
+    };
+
+    /**
+     * @class ReassemblyPool
+     * @brief Preallocated buffers reassembling fragmented messages.
+     *
+     * Fragments may arrive in any order and may be duplicated. A buffer is held until the message is complete or
+     * no fragment was received for the timeout passed to expire().
+     *
+     * @tparam TSlots The number of messages which can be reassembled at the same time.
+     * @tparam TCapacity The capacity of each buffer, i.e. the largest message which can be reassembled.
+     */
+    template<size_t TSlots, size_t TCapacity>
+    class ReassemblyPool {
+    public:
+        static_assert(TCapacity <= MAX_FRAGMENTED_MESSAGE_SIZE, "TCapacity exceeds the largest fragmented message");
+
+        /**
+         * @brief Adds the payload of a FRAGMENT_V1 frame.
+         *
+         * When REASSEMBLY_COMPLETE is returned, the message is available through device(), data() and size() until
+         * the next call.
+         *
+         * @param device The ID of the device which sent the fragment.
+         * @param payload The payload of the frame.
+         * @param length The size of the payload.
+         * @param now The current timestamp.
+         * @return The result of the operation.
+         */
+        ReassemblyStatus push(const DeviceID device, const uint8_t* payload, const uint8_t length, const TimeStamp now) {
+            completed = nullptr;
+            if (length <= internal::FRAGMENT_HEADER_SIZE) {
+                return REASSEMBLY_INVALID;
+            }
+
+            const uint8_t transfer = payload[0];
+            const uint8_t index    = payload[1];
+            const uint8_t count    = payload[2];
+            const uint8_t chunk    = length - internal::FRAGMENT_HEADER_SIZE;
+            const bool last        = index + 1 == count;
+            if (index >= count || (!last && chunk != internal::FRAGMENT_CHUNK_SIZE)) {
+                DEBUG_PRINTF("ReassemblyPool::push() - Invalid fragment %d/%d from %d\n", index, count, device);
+                return REASSEMBLY_INVALID;
+            }
+
+            auto slot = find(device, transfer);
+            const size_t minimumSize = (count - 1) * internal::FRAGMENT_CHUNK_SIZE + (last ? chunk : 1);
+            if (minimumSize > TCapacity) {
+                DEBUG_PRINTF("ReassemblyPool::push() - Message from %d does not fit (%d fragments)\n", device, count);
+                if (slot != nullptr) {
+                    slot->used = false;
+                }
+                return REASSEMBLY_TOO_LARGE;
+            }
+
+            if (slot == nullptr) {
+                slot = allocate(device, transfer, count);
+                if (slot == nullptr) {
+                    DEBUG_PRINTF("ReassemblyPool::push() - No free slot for a message from %d\n", device);
+                    return REASSEMBLY_NO_SLOT;
+                }
+            }
+            else if (slot->count != count) {
+                return REASSEMBLY_INVALID;
+            }
+
+            const uint8_t mask = 1 << (index % 8);
+            if (slot->fragments[index / 8] & mask) {
+                return REASSEMBLY_DUPLICATE;
+            }
+
+            const size_t offset = index * internal::FRAGMENT_CHUNK_SIZE;
+            memcpy(slot->data + offset, payload + internal::FRAGMENT_HEADER_SIZE, chunk);
+            slot->fragments[index / 8] |= mask;
+            slot->received++;
+            slot->updated = now;
+            if (last) {
+                slot->size = static_cast<MessageSize>(offset + chunk);
+            }
+
+            if (slot->received < slot->count) {
+                return REASSEMBLY_PENDING;
+            }
+            slot->used = false;
+            completed  = slot;
+            return REASSEMBLY_COMPLETE;
+        }
+
+        /**
+         * @brief Drops the messages which did not receive any fragment within the timeout.
+         *
+         * @param now The current timestamp.
+         * @param timeout The timeout in milliseconds.
+         * @param onExpired Called with the device ID of every dropped message.
+         * @return The number of dropped messages.
+         */
+        template<typename F>
+        size_t expire(const TimeStamp now, const TimeStamp timeout, F&& onExpired) {
+            size_t expired = 0;
+            for (auto& slot: slots) {
+                if (slot.used && now - slot.updated > timeout) {
+                    DEBUG_PRINTF("ReassemblyPool::expire() - Dropping incomplete message from %d (%d/%d)\n",
+                                 slot.device, slot.received, slot.count);
+                    slot.used = false;
+                    expired++;
+                    onExpired(slot.device);
+                }
+            }
+            return expired;
+        }
+
+        /**
+         * @brief Drops all messages of a device, e.g. after it disconnected.
+         * @param device The ID of the device.
+         */
+        void discard(const DeviceID device) {
+            for (auto& slot: slots) {
+                if (slot.device == device) {
+                    slot.used = false;
+                }
+            }
+        }
+
+        /**
+         * @brief Gets the number of messages being reassembled.
+         */
+        [[nodiscard]] size_t pending() const {
+            size_t count = 0;
+            for (const auto& slot: slots) {
+                count += slot.used ? 1 : 0;
+            }
+            return count;
+        }
+
+        [[nodiscard]] DeviceID device() const { return completed ? completed->device : 0; } ///< Sender of the message
+        [[nodiscard]] uint8_t* data() { return completed ? completed->data : nullptr; }     ///< The completed message
+        [[nodiscard]] MessageSize size() const { return completed ? completed->size : 0; }  ///< Size of the message
+
+    private:
+        /**
+         * @brief A buffer reassembling a single message.
+         */
+        struct Slot {
+            bool used;                                             ///< The slot holds an incomplete message
+            DeviceID device;                                       ///< The sender of the message
+            uint8_t transfer;                                      ///< The transfer ID of the message
+            uint8_t count;                                         ///< The number of fragments of the message
+            uint8_t received;                                      ///< The number of fragments received
+            MessageSize size;                                      ///< The size of the message (known from the last fragment)
+            TimeStamp updated;                                     ///< The timestamp of the last received fragment
+            uint8_t fragments[(fragmentCount(TCapacity) + 7) / 8]; ///< Bitmap of the received fragments
+            uint8_t data[TCapacity];                               ///< The message
+        };
+
+        Slot* find(const DeviceID device, const uint8_t transfer) {
+            for (auto& slot: slots) {
+                if (slot.used && slot.device == device && slot.transfer == transfer) {
+                    return &slot;
+                }
+            }
+            return nullptr;
+        }
+
+        Slot* allocate(const DeviceID device, const uint8_t transfer, const uint8_t count) {
+            for (auto& slot: slots) {
+                if (!slot.used) {
+                    slot.used     = true;
+                    slot.device   = device;
+                    slot.transfer = transfer;
+                    slot.count    = count;
+                    slot.received = 0;
+                    slot.size     = 0;
+                    memset(slot.fragments, 0, sizeof(slot.fragments));
+                    return &slot;
+                }
+            }
+            return nullptr;
+        }
+
+        Slot slots[TSlots]{};      ///< The reassembly buffers
+        Slot* completed = nullptr; ///< The slot of the last completed message
+    };
+} // namespace bpa
+
+#endif // BPA_FRAGMENTATION_H
@@ -0,0 +1,137 @@
+#ifndef BPA_FRAME_BATCH_H
+#define BPA_FRAME_BATCH_H
+
+#include "common.h"
+#include "BinaryMessage.h"
+
+namespace bpa {
+    /**
+     * @class FrameBatch
+     * @brief Fixed-capacity container which packs several frames back to back, e.g. to send them as one datagram.
+     *
+     * A batch with a single frame is byte-identical to that frame, so receivers which read one frame per datagram
+     * still understand single-frame batches.
+     *
+     * @tparam TCapacity The capacity of the batch in bytes.
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     */
+    template<size_t TCapacity, typename TChecksum = Fnv1aHash16>
+    class FrameBatch {
+    public:
+        /**
+         * @brief Creates an empty batch.
+         */
+        FrameBatch() = default;
+
+        /**
+         * @brief Encodes the message at the end of the batch.
+         * @param message The message to be appended.
+         * @return True if the message was appended, false if there is not enough space left.
+         */
+        bool append(const BinaryMessage& message) {
+            const auto length = encodeFrame<TChecksum>(message, buffer + size, TCapacity - size);
+            if (length == 0) {
+                return false;
+            }
+            size += length;
+            count++;
+            return true;
+        }
+
+        /**
+         * @brief Checks if a message with the given payload size fits into the remaining space.
+         * @param payloadSize The size of the message payload.
+         * @return True if the message fits into the batch.
+         */
+        [[nodiscard]] bool fits(const uint8_t payloadSize) const {
+            return frameLength<TChecksum>(payloadSize) <= TCapacity - size;
+        }
+
+        /**
+         * @brief Checks if a message, with its header basic or extended, fits into the remaining space.
+         * @param message The message.
+         * @return True if the message fits into the batch.
+         */
+        [[nodiscard]] bool fits(const BinaryMessage& message) const {
+            return frameLength<TChecksum>(message.start, message.size) <= TCapacity - size;
+        }
+
+        /**
+         * @brief Removes all frames from the batch.
+         */
+        void clear() {
+            size  = 0;
+            count = 0;
+        }
+
+        [[nodiscard]] const uint8_t* data() const { return buffer; } ///< Gets the encoded frames
+        [[nodiscard]] size_t length() const { return size; }         ///< Gets the number of encoded bytes
+        [[nodiscard]] size_t frames() const { return count; }        ///< Gets the number of frames in the batch
+        [[nodiscard]] bool empty() const { return count == 0; }      ///< Checks if the batch has no frames
+
+    private:
+        uint8_t buffer[TCapacity]{}; ///< Encoded frames
+        size_t size  = 0;            ///< Number of encoded bytes
+        size_t count = 0;            ///< Number of frames
+    };
+
+    /**
+     * @class FrameBatchReader
+     * @brief Iterates over frames packed back to back in memory (e.g. a received datagram) without copying them.
+     *
+     * A frame with an invalid checksum or format is reported with its status and the reader moves on to the next one.
+     * Iteration stops when the remaining bytes can not hold the declared frame.
+     *
+     * @tparam TChecksum The integrity policy of the frame trailer (see Checksum.h).
+     */
+    template<typename TChecksum = Fnv1aHash16>
+    class FrameBatchReader {
+    public:
+        /**
+         * @brief Creates a reader over the given memory.
+         * @param data Pointer to the first frame.
+         * @param length The number of bytes available.
+         */
+        FrameBatchReader(uint8_t* data, const size_t length) : data(data), length(length) {
+        }
+
+        /**
+         * @brief Decodes the next frame.
+         * @return True if a frame was decoded (check status() for its validity), false at the end of the data.
+         */
+        bool next() {
+            current = emptyMessage();
+            if (offset >= length) {
+                return false;
+            }
+
+            const size_t remaining = length - offset;
+            if (remaining < frameLength<TChecksum>(0) ||
+                remaining < frameLength<TChecksum>(data[offset], data[offset + 3])) {
+                DEBUG_PRINTF("FrameBatchReader::next() - Truncated frame at offset %d\n", offset);
+                currentStatus = STATUS_UNEXPECTED_END_OF_STREAM;
+                offset        = length;
+                return true;
+            }
+
+            const size_t frameSize       = frameLength<TChecksum>(data[offset], data[offset + 3]);
+            const auto [message, status] = decodeFrame<TChecksum>(data + offset, frameSize);
+            current       = message;
+            currentStatus = status;
+            offset += frameSize;
+            return true;
+        }
+
+        [[nodiscard]] const BinaryMessage& message() const { return current; } ///< Gets the last decoded message
+        [[nodiscard]] ValidationStatus status() const { return currentStatus; } ///< Gets the status of the last message
+
+    private:
+        uint8_t* data;                                                  ///< Pointer to the frames
+        size_t length;                                                  ///< Number of bytes available
+        size_t offset                  = 0;                             ///< Offset of the next frame
+        BinaryMessage current          = {UNDEFINED, 0, 0, 0, nullptr}; ///< The last decoded message
+        ValidationStatus currentStatus = STATUS_OK;                     ///< The status of the last decoded message
+    };
+} // namespace bpa
+
+#endif // BPA_FRAME_BATCH_H
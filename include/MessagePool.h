@@ -0,0 +1,180 @@
+#ifndef BPA_MESSAGE_POOL_H
+#define BPA_MESSAGE_POOL_H
+
+#include <atomic>
+#include <utility>
+#include "common.h"
+
+namespace bpa {
+    template<size_t TSlots, size_t TSlotSize>
+    class MessagePool;
+
+    /**
+     * @class MessageHandle
+     * @brief Owning handle of a received message stored in a MessagePool slot.
+     *
+     * Handles are moved, never copied, and give their slot back to the pool when destroyed. A message can be queued or
+     * passed to another task without copying its payload. The pool should outlive its handles.
+     */
+    class MessageHandle {
+    public:
+        /**
+         * @brief Creates an empty handle.
+         */
+        MessageHandle() = default;
+
+        MessageHandle(const MessageHandle&)            = delete;
+        MessageHandle& operator=(const MessageHandle&) = delete;
+
+        MessageHandle(MessageHandle&& other) noexcept { take(other); }
+
+        MessageHandle& operator=(MessageHandle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                take(other);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Gives the slot back to the pool.
+         */
+        ~MessageHandle() { reset(); }
+
+        /**
+         * @brief Gives the slot back to the pool, the handle becomes empty.
+         */
+        void reset() {
+            if (owner != nullptr) {
+                owner->store(false, std::memory_order_release);
+            }
+            owner    = nullptr;
+            slot     = nullptr;
+            payload  = nullptr;
+            slotSize = 0;
+            length   = 0;
+            sender   = 0;
+        }
+
+        /**
+         * @brief Sets the message held in the slot.
+         * @param from The sender of the message.
+         * @param offset The offset of the payload in the slot.
+         * @param size The size of the payload.
+         */
+        void assign(const DeviceID from, const size_t offset, const MessageSize size) {
+            sender  = from;
+            payload = slot + offset;
+            length  = size;
+        }
+
+        explicit operator bool() const { return owner != nullptr; } ///< Checks if the handle owns a slot
+
+        [[nodiscard]] DeviceID device() const { return sender; }   ///< Gets the sender of the message
+        [[nodiscard]] uint8_t* data() const { return payload; }    ///< Gets the payload of the message
+        [[nodiscard]] MessageSize size() const { return length; }  ///< Gets the size of the payload
+        [[nodiscard]] uint8_t* storage() const { return slot; }    ///< Gets the memory of the slot, for filling it
+        [[nodiscard]] size_t capacity() const { return slotSize; } ///< Gets the size of the slot
+
+    private:
+        template<size_t, size_t>
+        friend class MessagePool;
+
+        MessageHandle(std::atomic<bool>* owner, uint8_t* slot, const size_t capacity) : owner(owner), slot(slot),
+            slotSize(capacity) {
+        }
+
+        void take(MessageHandle& other) {
+            owner    = std::exchange(other.owner, nullptr);
+            slot     = std::exchange(other.slot, nullptr);
+            payload  = std::exchange(other.payload, nullptr);
+            slotSize = std::exchange(other.slotSize, 0);
+            length   = std::exchange(other.length, 0);
+            sender   = std::exchange(other.sender, 0);
+        }
+
+        std::atomic<bool>* owner = nullptr; ///< The in-use flag of the slot
+        uint8_t* slot            = nullptr; ///< The memory of the slot
+        uint8_t* payload         = nullptr; ///< The payload of the message, inside the slot
+        size_t slotSize          = 0;       ///< The size of the slot
+        MessageSize length       = 0;       ///< The size of the payload
+        DeviceID sender          = 0;       ///< The sender of the message
+    };
+
+    /**
+     * @class MessagePool
+     * @brief Fixed-capacity pool of message buffers handed out as MessageHandle.
+     *
+     * Slots are acquired from one context (e.g. the tunnel in loop()), handles can be released from any task.
+     * Nothing is allocated on the heap.
+     *
+     * @tparam TSlots The number of slots.
+     * @tparam TSlotSize The size of each slot in bytes.
+     */
+    template<size_t TSlots, size_t TSlotSize>
+    class MessagePool {
+    public:
+        static constexpr size_t SLOTS     = TSlots;    ///< The number of slots
+        static constexpr size_t SLOT_SIZE = TSlotSize; ///< The size of each slot in bytes
+
+        /**
+         * @brief Creates a pool with all slots free.
+         */
+        MessagePool() = default;
+
+        MessagePool(const MessagePool&)            = delete;
+        MessagePool& operator=(const MessagePool&) = delete;
+
+        /**
+         * @brief Takes a free slot.
+         * @return A handle owning the slot, or an empty handle if all slots are in use.
+         */
+        MessageHandle acquire() {
+            for (size_t i = 0; i < TSlots; i++) {
+                if (!used[i].load(std::memory_order_acquire)) {
+                    used[i].store(true, std::memory_order_relaxed);
+                    return {&used[i], slots[i], TSlotSize};
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Gets the number of free slots.
+         */
+        [[nodiscard]] size_t available() const {
+            size_t count = 0;
+            for (const auto& slot: used) {
+                count += slot.load(std::memory_order_acquire) ? 0 : 1;
+            }
+            return count;
+        }
+
+    private:
+        uint8_t slots[TSlots][TSlotSize]{}; ///< The message buffers
+        std::atomic<bool> used[TSlots]{};   ///< The in-use flag of each slot
+    };
+
+    /**
+     * @brief A pool without slots for tunnels which only deliver messages to the raw pointer callback, it takes no
+     * buffer and acquire() always fails.
+     *
+     * @tparam TSlotSize The size each slot would have.
+     */
+    template<size_t TSlotSize>
+    class MessagePool<0, TSlotSize> {
+    public:
+        static constexpr size_t SLOTS     = 0;         ///< The number of slots
+        static constexpr size_t SLOT_SIZE = TSlotSize; ///< The size each slot would have
+
+        MessagePool() = default;
+
+        MessagePool(const MessagePool&)            = delete;
+        MessagePool& operator=(const MessagePool&) = delete;
+
+        MessageHandle acquire() { return {}; }               ///< Returns an empty handle
+        [[nodiscard]] size_t available() const { return 0; } ///< Gets the number of free slots, always 0
+    };
+} // namespace bpa
+
+#endif // BPA_MESSAGE_POOL_H
@@ -0,0 +1,167 @@
+#ifndef BPA_RING_BUFFER_H
+#define BPA_RING_BUFFER_H
+
+#include <Stream.h>
+#include <atomic>
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @class RingBufferStream
+     * @brief Lock-free single-producer/single-consumer byte queue exposed as a Stream.
+     *
+     * The producer (e.g. the UART receive interrupt or a DMA completion handler) calls push(), the consumer (loop())
+     * uses the Stream interface or reads the queued bytes in place with span() and consume(). Each index is written by
+     * one side only, so no locks and no disabled interrupts are needed. On the ESP8266 push() is inlined into the
+     * interrupt handler, which should be placed in IRAM as usual.
+     *
+     * Nothing is ever allocated. When the buffer is full the new bytes are dropped and counted in overflows().
+     *
+     * @tparam TCapacity The capacity of the buffer in bytes, a power of two.
+     */
+    template<size_t TCapacity>
+    class RingBufferStream : public Stream {
+    public:
+        static_assert(TCapacity > 0 && (TCapacity & (TCapacity - 1)) == 0, "The capacity should be a power of two");
+
+        static constexpr size_t CAPACITY = TCapacity; ///< The capacity of the buffer in bytes
+
+        /**
+         * @brief Creates an empty buffer.
+         */
+        RingBufferStream() = default;
+
+        /**
+         * @brief Appends a byte, producer side.
+         * @param byte The received byte.
+         * @return True if the byte was queued, false if the buffer is full.
+         */
+        bool push(const uint8_t byte) {
+            const auto in = head.load(std::memory_order_relaxed);
+            if (in - tail.load(std::memory_order_acquire) == TCapacity) {
+                overflowed++;
+                return false;
+            }
+            buffer[in & MASK] = byte;
+            head.store(in + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Appends a block of bytes, producer side.
+         * @param bytes The received bytes.
+         * @param length The number of received bytes.
+         * @return The number of queued bytes, the rest did not fit.
+         */
+        size_t push(const uint8_t* bytes, const size_t length) {
+            const auto in     = head.load(std::memory_order_relaxed);
+            const auto free   = TCapacity - (in - tail.load(std::memory_order_acquire));
+            const auto queued = length < free ? length : free;
+            const auto offset = in & MASK;
+            const auto first  = queued < TCapacity - offset ? queued : TCapacity - offset;
+            memcpy(buffer + offset, bytes, first);
+            memcpy(buffer, bytes + first, queued - first);
+            head.store(in + queued, std::memory_order_release);
+            overflowed += length - queued;
+            return queued;
+        }
+
+        /**
+         * @brief Gets the queued bytes which are stored contiguously, consumer side.
+         *
+         * The bytes stay in the buffer until they are released with consume(), so they can be used in place.
+         *
+         * @param length Receives the number of contiguous bytes, it is smaller than available() if the queued bytes
+         *               wrap around the end of the buffer.
+         * @return The first queued byte.
+         */
+        uint8_t* span(size_t& length) {
+            const auto out   = tail.load(std::memory_order_relaxed);
+            const auto ready = head.load(std::memory_order_acquire) - out;
+            const auto index = out & MASK;
+            length           = ready < TCapacity - index ? ready : TCapacity - index;
+            return buffer + index;
+        }
+
+        /**
+         * @brief Copies queued bytes without removing them, consumer side.
+         * @param bytes The memory receiving the bytes.
+         * @param length The number of bytes to copy.
+         * @return The number of copied bytes.
+         */
+        size_t peekBytes(uint8_t* bytes, const size_t length) const {
+            const auto out    = tail.load(std::memory_order_relaxed);
+            const auto ready  = head.load(std::memory_order_acquire) - out;
+            const auto copied = length < ready ? length : ready;
+            const auto index  = out & MASK;
+            const auto first  = copied < TCapacity - index ? copied : TCapacity - index;
+            memcpy(bytes, buffer + index, first);
+            memcpy(bytes + first, buffer, copied - first);
+            return copied;
+        }
+
+        /**
+         * @brief Removes queued bytes and hands their space back to the producer, consumer side.
+         * @param length The number of bytes to remove, at most available().
+         */
+        void consume(const size_t length) {
+            tail.store(tail.load(std::memory_order_relaxed) + length, std::memory_order_release);
+        }
+
+        [[nodiscard]] size_t overflows() const { return overflowed; } ///< Gets the number of dropped bytes
+
+        int available() override {
+            return static_cast<int>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+        }
+
+        int read() override {
+            const auto byte = peek();
+            if (byte >= 0) {
+                consume(1);
+            }
+            return byte;
+        }
+
+        int peek() override {
+            const auto out = tail.load(std::memory_order_relaxed);
+            return head.load(std::memory_order_acquire) == out ? -1 : buffer[out & MASK];
+        }
+
+        int read(uint8_t* bytes, const size_t length) override {
+            const auto copied = peekBytes(bytes, length);
+            consume(copied);
+            return static_cast<int>(copied);
+        }
+
+        /**
+         * @brief Reads the queued bytes. Never waits for more data, unlike the default implementation.
+         */
+        size_t readBytes(char* bytes, const size_t length) override {
+            return static_cast<size_t>(read(reinterpret_cast<uint8_t*>(bytes), length));
+        }
+
+        /**
+         * @brief Queues a byte as the producer, e.g. for a loopback link.
+         */
+        size_t write(const uint8_t byte) override { return push(byte) ? 1 : 0; }
+
+        /**
+         * @brief Queues a block of bytes as the producer, e.g. for a loopback link.
+         */
+        size_t write(const uint8_t* bytes, const size_t length) override { return push(bytes, length); }
+
+        using Stream::read;
+        using Stream::readBytes;
+        using Stream::write;
+
+    private:
+        static constexpr size_t MASK = TCapacity - 1; ///< Maps a free-running index to a position in the buffer
+
+        uint8_t buffer[TCapacity]{}; ///< Queued bytes
+        std::atomic<size_t> head{0}; ///< Free-running index of the next written byte, updated by the producer
+        std::atomic<size_t> tail{0}; ///< Free-running index of the next read byte, updated by the consumer
+        size_t overflowed = 0;       ///< Number of dropped bytes, updated by the producer
+    };
+} // namespace bpa
+
+#endif // BPA_RING_BUFFER_H
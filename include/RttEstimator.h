@@ -0,0 +1,65 @@
+#ifndef BPA_RTT_ESTIMATOR_H
+#define BPA_RTT_ESTIMATOR_H
+
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @class RttEstimator
+     * @brief Smoothed round-trip time and its variation, as proposed by Jacobson and Karels (see RFC 6298).
+     *
+     * Both values are kept in fixed point: the smoothed RTT is scaled by 8 and the variation by 4, so the gains of
+     * 1/8 and 1/4 are plain shifts. Samples of retransmitted frames should not be passed in (Karn's algorithm).
+     */
+    class RttEstimator {
+    public:
+        /**
+         * @brief Creates an estimator without samples.
+         */
+        RttEstimator() = default;
+
+        /**
+         * @brief Adds a round-trip time measurement.
+         * @param rtt The time between sending a frame and receiving its acknowledgement, in milliseconds.
+         */
+        void sample(const TimeStamp rtt) {
+            const auto measured = static_cast<long>(rtt);
+            if (smoothed == 0) {
+                smoothed  = (measured << 3) | 1; // Never 0 once a sample was taken
+                variation = measured << 1;
+                return;
+            }
+
+            auto delta = measured - (smoothed >> 3);
+            smoothed += delta;
+            smoothed  = smoothed > 0 ? smoothed : 1;
+            delta     = delta < 0 ? -delta : delta;
+            variation += delta - (variation >> 2);
+        }
+
+        /**
+         * @brief Gets the retransmission timeout derived from the samples, SRTT + 4 * RTTVAR.
+         * @param initial The timeout returned before the first sample.
+         * @param minimum The lower bound of the timeout.
+         * @param maximum The upper bound of the timeout.
+         */
+        [[nodiscard]] TimeStamp timeout(const TimeStamp initial, const TimeStamp minimum,
+                                        const TimeStamp maximum) const {
+            if (smoothed == 0) {
+                return initial;
+            }
+
+            const auto rto = static_cast<TimeStamp>((smoothed >> 3) + variation);
+            return rto < minimum ? minimum : rto > maximum ? maximum : rto;
+        }
+
+        [[nodiscard]] TimeStamp srtt() const { return static_cast<TimeStamp>(smoothed >> 3); }     ///< Gets the smoothed RTT
+        [[nodiscard]] TimeStamp rttvar() const { return static_cast<TimeStamp>(variation >> 2); } ///< Gets the RTT variation
+
+    private:
+        long smoothed  = 0; ///< The smoothed RTT scaled by 8, 0 until the first sample
+        long variation = 0; ///< The RTT variation scaled by 4
+    };
+} // namespace bpa
+
+#endif // BPA_RTT_ESTIMATOR_H
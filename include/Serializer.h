@@ -0,0 +1,294 @@
+#ifndef BPA_SERIALIZER_H
+#define BPA_SERIALIZER_H
+
+#include <string.h>
+#include <type_traits>
+#include "common.h"
+
+/**
+ * Typed payload layer.
+ *
+ * A layout describes once how the fields of a struct are laid out in a payload, pack() writes them straight into the
+ * buffer passed to Tunnel::sendMessage() and unpack() reads them from the buffer delivered to onMessageReceived.
+ *
+ * @code
+ * struct Sample {
+ *     uint16_t sensor;
+ *     uint32_t timestamp;
+ *     int16_t value;
+ * };
+ *
+ * using SampleLayout = bpa::Layout<bpa::Field<&Sample::sensor>,
+ *                                  bpa::Field<&Sample::timestamp, bpa::Varint>,
+ *                                  bpa::Field<&Sample::value, bpa::Varint>>;
+ *
+ * uint8_t payload[SampleLayout::MAX_SIZE];
+ * tunnel.sendMessage(gateway, payload, SampleLayout::pack(sample, payload, sizeof(payload)));
+ * @endcode
+ */
+namespace bpa {
+    /**
+     * @namespace internal
+     * @brief Namespace containing the helpers of the typed payload layer.
+     */
+    namespace internal {
+        /**
+         * @brief Unsigned integer with the same size as T, used to move the bits of any scalar field.
+         */
+        template<typename T>
+        using FieldBits = std::conditional_t<sizeof(T) == 1, uint8_t,
+            std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+        template<typename T>
+        FieldBits<T> toBits(const T& value) {
+            FieldBits<T> bits;
+            memcpy(&bits, &value, sizeof(T));
+            return bits;
+        }
+
+        template<typename T>
+        T fromBits(const FieldBits<T> bits) {
+            T value;
+            memcpy(&value, &bits, sizeof(T));
+            return value;
+        }
+
+        template<typename>
+        struct MemberTraits;
+
+        template<typename TClass, typename TValue>
+        struct MemberTraits<TValue TClass::*> {
+            using Class = TClass;
+            using Value = TValue;
+        };
+    } // namespace internal
+
+    /**
+     * @struct Fixed
+     * @brief Fixed-width encoding: the bytes of the value, most significant first (same order as the frame trailer).
+     *
+     * Supports integers, enums, bool, float and double.
+     */
+    struct Fixed {
+        template<typename T>
+        static constexpr size_t MAX_SIZE = sizeof(T); ///< The largest encoding of a T
+
+        template<typename T>
+        static constexpr bool FIXED_SIZE = true; ///< The encoding of a T always takes MAX_SIZE bytes
+
+        template<typename T>
+        static constexpr size_t size(const T&) { return sizeof(T); }
+
+        template<typename T>
+        static size_t encode(const T& value, uint8_t* out) {
+            static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Fixed supports scalar fields only");
+            const auto bits = internal::toBits(value);
+            for (size_t i = 0; i < sizeof(T); i++) {
+                out[i] = static_cast<uint8_t>(bits >> (8 * (sizeof(T) - 1 - i)));
+            }
+            return sizeof(T);
+        }
+
+        /**
+         * @brief Decodes a value, the caller checks that MAX_SIZE bytes are available.
+         */
+        template<typename T>
+        static size_t decode(const uint8_t* in, size_t, T& value) {
+            internal::FieldBits<T> bits = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                bits = static_cast<internal::FieldBits<T>>(bits << 8 | in[i]);
+            }
+            value = internal::fromBits<T>(bits);
+            return sizeof(T);
+        }
+    };
+
+    /**
+     * @struct Varint
+     * @brief Variable-length encoding (LEB128): 7 bits per byte, least significant group first. Signed integers are
+     * zigzag-encoded, so small negative values stay short.
+     */
+    struct Varint {
+        template<typename T>
+        static constexpr size_t MAX_SIZE = (sizeof(T) * 8 + 6) / 7; ///< The largest encoding of a T
+
+        template<typename T>
+        static constexpr bool FIXED_SIZE = false; ///< The size of the encoding depends on the value
+
+        template<typename T>
+        static constexpr size_t size(const T& value) {
+            auto bits   = zigzag(value);
+            size_t size = 1;
+            while (bits >= 0x80) {
+                bits >>= 7;
+                size++;
+            }
+            return size;
+        }
+
+        template<typename T>
+        static size_t encode(const T& value, uint8_t* out) {
+            auto bits   = zigzag(value);
+            size_t size = 0;
+            while (bits >= 0x80) {
+                out[size++] = static_cast<uint8_t>(bits | 0x80);
+                bits >>= 7;
+            }
+            out[size++] = static_cast<uint8_t>(bits);
+            return size;
+        }
+
+        template<typename T>
+        static size_t decode(const uint8_t* in, const size_t remaining, T& value) {
+            using Bits = std::make_unsigned_t<T>;
+            Bits bits  = 0;
+            for (size_t i = 0; i < remaining && i < MAX_SIZE<T>; i++) {
+                if (i == MAX_SIZE<T> - 1 && (in[i] & 0x7F) >> (sizeof(T) * 8 - 7 * i) != 0) {
+                    return 0; // The value does not fit into T
+                }
+                bits |= static_cast<Bits>(static_cast<Bits>(in[i] & 0x7F) << (7 * i));
+                if ((in[i] & 0x80) == 0) {
+                    value = unzigzag<T>(bits);
+                    return i + 1;
+                }
+            }
+            return 0; // Truncated or longer than the type
+        }
+
+    private:
+        template<typename T>
+        static constexpr std::make_unsigned_t<T> zigzag(const T value) {
+            static_assert(std::is_integral_v<T>, "Varint supports integer fields only");
+            using Bits = std::make_unsigned_t<T>;
+            if constexpr (std::is_signed_v<T>) {
+                return static_cast<Bits>((static_cast<Bits>(value) << 1) ^ static_cast<Bits>(value < 0 ? -1 : 0));
+            }
+            else {
+                return value;
+            }
+        }
+
+        template<typename T>
+        static constexpr T unzigzag(const std::make_unsigned_t<T> bits) {
+            if constexpr (std::is_signed_v<T>) {
+                return static_cast<T>((bits >> 1) ^ (~(bits & 1) + 1));
+            }
+            else {
+                return bits;
+            }
+        }
+    };
+
+    /**
+     * @struct Field
+     * @brief Binds a struct member to its encoding.
+     *
+     * @tparam TMember Pointer to the member, e.g. `&Sample::sensor`.
+     * @tparam TEncoding The encoding of the member (Fixed or Varint).
+     */
+    template<auto TMember, typename TEncoding = Fixed>
+    struct Field {
+        using Class = typename internal::MemberTraits<decltype(TMember)>::Class; ///< The struct holding the member
+        using Value = typename internal::MemberTraits<decltype(TMember)>::Value; ///< The type of the member
+
+        static constexpr size_t MAX_SIZE = TEncoding::template MAX_SIZE<Value>;   ///< The largest encoding
+        static constexpr bool FIXED_SIZE = TEncoding::template FIXED_SIZE<Value>; ///< The size never changes
+
+        static constexpr size_t size(const Class& object) { return TEncoding::size(object.*TMember); }
+
+        static size_t encode(const Class& object, uint8_t* out) { return TEncoding::encode(object.*TMember, out); }
+
+        static size_t decode(const uint8_t* in, const size_t remaining, Class& object) {
+            return TEncoding::decode(in, remaining, object.*TMember);
+        }
+    };
+
+    /**
+     * @class Layout
+     * @brief The payload layout of a struct: its fields encoded one after another, in the given order.
+     *
+     * All sizes are computed at compile time for layouts made of fixed-width fields only. Such layouts are decoded
+     * after a single length check.
+     *
+     * @tparam TFields The fields of the layout (see Field), they should all belong to the same struct.
+     */
+    template<typename TField, typename... TFields>
+    class Layout {
+    public:
+        using Type = typename TField::Class; ///< The struct described by the layout
+
+        static_assert((std::is_same_v<Type, typename TFields::Class> && ...), "All fields should belong to one struct");
+
+        static constexpr size_t MAX_SIZE = (TField::MAX_SIZE + ... + TFields::MAX_SIZE); ///< The largest payload
+        static constexpr bool FIXED_SIZE = (TField::FIXED_SIZE && ... && TFields::FIXED_SIZE); ///< No varint field
+
+        static_assert(MAX_SIZE <= BPA_MAX_MESSAGE_SIZE, "The layout does not fit into a message");
+
+        /**
+         * @brief Gets the size of the payload of the given value.
+         */
+        static constexpr size_t size(const Type& value) {
+            if constexpr (FIXED_SIZE) {
+                return MAX_SIZE;
+            }
+            else {
+                return (TField::size(value) + ... + TFields::size(value));
+            }
+        }
+
+        /**
+         * @brief Encodes the value.
+         *
+         * @param value The value to be encoded.
+         * @param buffer The memory receiving the payload, usually MAX_SIZE bytes.
+         * @param capacity The number of bytes available at `buffer`.
+         * @return The size of the payload, or 0 if the capacity is not enough.
+         */
+        static size_t pack(const Type& value, uint8_t* buffer, const size_t capacity) {
+            if (capacity < size(value)) {
+                return 0;
+            }
+
+            size_t offset = TField::encode(value, buffer);
+            ((offset += TFields::encode(value, buffer + offset)), ...);
+            return offset;
+        }
+
+        /**
+         * @brief Decodes a payload.
+         *
+         * @param buffer The payload, e.g. the data passed to the onMessageReceived callback.
+         * @param length The size of the payload.
+         * @param value The value receiving the fields.
+         * @return True if the payload matches the layout exactly, false otherwise (the value may be partly updated).
+         */
+        static bool unpack(const uint8_t* buffer, const size_t length, Type& value) {
+            if constexpr (FIXED_SIZE) {
+                if (length != MAX_SIZE) {
+                    return false;
+                }
+
+                size_t offset = TField::decode(buffer, length, value);
+                ((offset += TFields::decode(buffer + offset, length - offset, value)), ...);
+                return true;
+            }
+            else {
+                size_t offset = 0;
+                const auto decode = [&](auto field) {
+                    using TCurrent = decltype(field);
+                    if constexpr (TCurrent::FIXED_SIZE) {
+                        if (length - offset < TCurrent::MAX_SIZE) {
+                            return false;
+                        }
+                    }
+                    const auto read = TCurrent::decode(buffer + offset, length - offset, value);
+                    offset += read;
+                    return read != 0;
+                };
+                return decode(TField{}) && (decode(TFields{}) && ...) && offset == length;
+            }
+        }
+    };
+} // namespace bpa
+
+#endif // BPA_SERIALIZER_H
@@ -0,0 +1,310 @@
+#ifndef BPA_SLIDING_WINDOW_H
+#define BPA_SLIDING_WINDOW_H
+
+#include <type_traits>
+#include "common.h"
+
+namespace bpa {
+    constexpr MessageID BASIC_SEQUENCE_LIMIT    = 0xFF;   ///< The last sequence number with a basic header
+    constexpr MessageID EXTENDED_SEQUENCE_LIMIT = 0xFFFF; ///< The last sequence number with an extended header
+
+    /**
+     * @brief Gets the sequence number which follows another one by the given number of steps.
+     *
+     * Sequence numbers are carried in the message ID of the frames, so they run from 1 to the limit and skip 0: up
+     * to 255 with a basic header, up to 65535 with an extended one.
+     */
+    constexpr MessageID advanceSequence(const MessageID sequence, const MessageID steps = 1,
+                                        const MessageID limit = BASIC_SEQUENCE_LIMIT) {
+        return static_cast<MessageID>((static_cast<uint32_t>(sequence) - 1 + steps) % limit + 1);
+    }
+
+    /**
+     * @brief Gets the number of steps from one sequence number to another one, between 0 and `limit - 1`.
+     *
+     * A distance above `limit / 2` means that `to` precedes `from`.
+     */
+    constexpr MessageID sequenceDistance(const MessageID from, const MessageID to,
+                                         const MessageID limit = BASIC_SEQUENCE_LIMIT) {
+        return static_cast<MessageID>((static_cast<uint32_t>(to) + limit - from) % limit);
+    }
+
+    /**
+     * @brief Gets the mask of the lowest bits of a bitmap of 32 bits.
+     */
+    constexpr uint32_t lowBits(const uint8_t count) {
+        return count >= 32 ? 0xFFFFFFFF : (static_cast<uint32_t>(1) << count) - 1;
+    }
+
+    /**
+     * @class SendWindow
+     * @brief The frames sent to a device which are not acknowledged yet.
+     *
+     * The window holds the sequence number of the oldest unacknowledged frame, a bitmap of the frames in flight and
+     * the send time of each of them in a small ring. Acknowledging a frame, a cumulative acknowledgement or a bitmap
+     * of selective ones takes constant time per acknowledged frame. Only the oldest frame in flight is checked for a
+     * timeout: frames are sent in order, so it is the first one to expire unless it was retransmitted.
+     *
+     * @tparam TSize The maximum number of frames in flight, at most 32.
+     */
+    template<size_t TSize>
+    class SendWindow {
+    public:
+        static_assert(TSize > 0 && TSize <= 32, "The window size should be between 1 and 32");
+
+        static constexpr size_t SIZE = TSize; ///< The maximum number of frames in flight
+
+        /**
+         * @brief A frame in flight.
+         */
+        struct Frame {
+            TimeStamp sentAt; ///< The time of the last transmission
+            uint8_t attempts; ///< The number of retransmissions
+            uint8_t tag;      ///< Data of the owner, e.g. the buffer holding the payload
+        };
+
+        /**
+         * @brief Creates an empty window using basic sequence numbers, the first frame gets the sequence number 1.
+         */
+        SendWindow() : SendWindow(BASIC_SEQUENCE_LIMIT) {
+        }
+
+        /**
+         * @brief Creates an empty window, the first frame gets the sequence number 1.
+         * @param limit The last sequence number, BASIC_SEQUENCE_LIMIT or EXTENDED_SEQUENCE_LIMIT.
+         */
+        explicit SendWindow(const MessageID limit) : limit(limit) {
+        }
+
+        /**
+         * @brief Takes the next sequence number for a frame sent now.
+         * @param now The current timestamp.
+         * @param tag Data of the owner, passed back when the frame leaves the window.
+         * @return The sequence number of the frame, or 0 if the window is full.
+         */
+        MessageID push(const TimeStamp now, const uint8_t tag = 0) {
+            const auto offset = inFlight();
+            if (offset == TSize) {
+                return 0;
+            }
+
+            const auto sequence = next;
+            frames[(first + offset) % TSize] = {now, 0, tag};
+            pending |= static_cast<uint32_t>(1) << offset;
+            next = advanceSequence(next, 1, limit);
+            return sequence;
+        }
+
+        /**
+         * @brief Acknowledges a single frame.
+         * @param sequence The sequence number of the frame.
+         * @param acknowledged Called with the sequence number and the frame if it was in flight.
+         * @return True if the frame was in flight.
+         */
+        template<typename TCallback, typename = std::enable_if_t<std::is_invocable_v<TCallback, MessageID, Frame&>>>
+        bool acknowledge(const MessageID sequence, TCallback&& acknowledged) {
+            const auto offset = sequenceDistance(base, sequence, limit);
+            if (offset >= inFlight() || !(pending & static_cast<uint32_t>(1) << offset)) {
+                return false;
+            }
+
+            pending &= ~(static_cast<uint32_t>(1) << offset);
+            acknowledged(sequence, frames[(first + offset) % TSize]);
+            slide();
+            return true;
+        }
+
+        /**
+         * @brief Acknowledges the frames reported by the receiver.
+         * @param cumulative The last sequence number received in order, all frames up to it are acknowledged.
+         * @param selective The frames received after a gap, bit `i` stands for the sequence number `cumulative + 1 + i`.
+         * @param acknowledged Called with the sequence number and the frame of every frame which was in flight.
+         * @return The number of frames which were in flight.
+         */
+        template<typename TCallback>
+        size_t acknowledge(const MessageID cumulative, const uint32_t selective, TCallback&& acknowledged) {
+            const auto count    = inFlight();
+            const auto before   = pending;
+            const auto received = advanceSequence(cumulative, 1, limit);
+            const auto offset   = sequenceDistance(base, received, limit);
+            if (offset <= count) {
+                pending &= ~lowBits(static_cast<uint8_t>(offset));
+                pending &= offset >= 32 ? 0xFFFFFFFF : ~(selective << offset);
+            }
+            else {
+                // The report starts before the window, the frames before it were acknowledged already
+                const auto behind = static_cast<MessageID>(limit - offset);
+                pending &= behind >= 32 ? 0xFFFFFFFF : ~(selective >> behind);
+            }
+
+            size_t total = 0;
+            for (auto bits = before & ~pending; bits != 0; bits &= bits - 1, total++) {
+                const auto index = static_cast<uint8_t>(__builtin_ctz(bits));
+                acknowledged(advanceSequence(base, index, limit), frames[(first + index) % TSize]);
+            }
+            slide();
+            return total;
+        }
+
+        bool acknowledge(const MessageID sequence) { return acknowledge(sequence, [](MessageID, const Frame&) {}); }
+
+        size_t acknowledge(const MessageID cumulative, const uint32_t selective) {
+            return acknowledge(cumulative, selective, [](MessageID, const Frame&) {});
+        }
+
+        /**
+         * @brief Gets the oldest frame in flight, the one to check for a timeout.
+         * @return The frame, or nullptr if no frame is in flight.
+         */
+        Frame* oldestFrame() { return pending == 0 ? nullptr : &frames[first]; }
+
+        /**
+         * @brief Gives up the oldest frame in flight, e.g. when it timed out.
+         * @return The sequence number of the frame, or 0 if no frame is in flight.
+         */
+        MessageID dropOldest() {
+            if (pending == 0) {
+                return 0;
+            }
+
+            const auto sequence = base;
+            pending &= ~static_cast<uint32_t>(1);
+            slide();
+            return sequence;
+        }
+
+        /**
+         * @brief Gives up all frames in flight.
+         * @param dropped Called with the sequence number and the frame of every frame in flight.
+         */
+        template<typename TCallback>
+        void clear(TCallback&& dropped) {
+            for (auto bits = pending; bits != 0; bits &= bits - 1) {
+                const auto index = static_cast<uint8_t>(__builtin_ctz(bits));
+                dropped(advanceSequence(base, index, limit), frames[(first + index) % TSize]);
+            }
+            pending = 0;
+            slide();
+        }
+
+        /**
+         * @brief Gets the number of frames between the oldest unacknowledged frame and the next sent one.
+         */
+        [[nodiscard]] size_t inFlight() const { return sequenceDistance(base, next, limit); }
+
+        /**
+         * @brief Gets the number of frames which are not acknowledged, frames acknowledged after a gap do not count.
+         */
+        [[nodiscard]] size_t outstanding() const { return __builtin_popcount(pending); }
+
+        [[nodiscard]] size_t available() const { return TSize - inFlight(); } ///< Gets the number of free slots
+        [[nodiscard]] MessageID oldest() const { return base; }               ///< Gets the oldest unacknowledged frame
+        [[nodiscard]] uint32_t unacknowledged() const { return pending; }     ///< Gets the bitmap of the frames in flight
+        [[nodiscard]] MessageID sequenceLimit() const { return limit; }       ///< Gets the last sequence number
+
+    private:
+        /**
+         * @brief Moves the start of the window to the oldest unacknowledged frame.
+         */
+        void slide() {
+            const auto steps = pending == 0 ? static_cast<uint8_t>(inFlight())
+                                            : static_cast<uint8_t>(__builtin_ctz(pending));
+            pending = pending == 0 ? 0 : pending >> steps;
+            base    = advanceSequence(base, steps, limit);
+            first   = (first + steps) % TSize;
+        }
+
+        Frame frames[TSize]{}; ///< The frames in flight, starting at `first`
+        uint32_t pending = 0;  ///< Bit `i` is set while the frame `base + i` is not acknowledged
+        MessageID base   = 1;  ///< The sequence number of the oldest unacknowledged frame
+        MessageID next   = 1;  ///< The sequence number of the next sent frame
+        MessageID limit;       ///< The last sequence number
+        uint8_t first    = 0;  ///< The position of the oldest unacknowledged frame in the ring
+    };
+
+    /**
+     * @class ReceiveWindow
+     * @brief The frames received from a device, reported back as a cumulative and a selective acknowledgement.
+     *
+     * Frames up to cumulative() were all received, a bitmap tracks the 32 frames which follow it. The same state tells
+     * duplicates apart in constant time, frames older than the bitmap count as received.
+     */
+    class ReceiveWindow {
+    public:
+        static constexpr uint8_t SELECTIVE_BITS = 32; ///< The number of frames tracked after the cumulative one
+
+        /**
+         * @brief Creates an empty window using basic sequence numbers, the first expected frame has the sequence number 1.
+         */
+        ReceiveWindow() : ReceiveWindow(BASIC_SEQUENCE_LIMIT) {
+        }
+
+        /**
+         * @brief Creates an empty window, the first expected frame has the sequence number 1.
+         * @param limit The last sequence number, BASIC_SEQUENCE_LIMIT or EXTENDED_SEQUENCE_LIMIT.
+         */
+        explicit ReceiveWindow(const MessageID limit) : limit(limit) {
+        }
+
+        /**
+         * @brief Records a received frame.
+         * @param sequence The sequence number of the frame.
+         * @return True if the frame was not received before.
+         */
+        bool accept(const MessageID sequence) {
+            auto offset = sequenceDistance(expected, sequence, limit);
+            if (offset > limit / 2) {
+                return false; // Older than the window, received already
+            }
+            if (offset >= SELECTIVE_BITS) {
+                // The sender moved on, the frames in between are not coming anymore
+                const auto skipped = static_cast<MessageID>(offset - SELECTIVE_BITS + 1);
+                received = skipped >= 32 ? 0 : received >> skipped;
+                expected = advanceSequence(expected, skipped, limit);
+                offset -= skipped;
+            }
+
+            const auto bit = static_cast<uint32_t>(1) << offset;
+            if (received & bit) {
+                return false;
+            }
+
+            received |= bit;
+            const auto steps = received == 0xFFFFFFFF ? 32 : __builtin_ctz(~received);
+            received = steps >= 32 ? 0 : received >> steps;
+            expected = advanceSequence(expected, static_cast<MessageID>(steps), limit);
+            return true;
+        }
+
+        /**
+         * @brief Checks if a frame was received already, without recording it.
+         * @param sequence The sequence number of the frame.
+         */
+        [[nodiscard]] bool contains(const MessageID sequence) const {
+            const auto offset = sequenceDistance(expected, sequence, limit);
+            if (offset > limit / 2) {
+                return true;
+            }
+            return offset < SELECTIVE_BITS && (received & static_cast<uint32_t>(1) << offset);
+        }
+
+        /**
+         * @brief Gets the last sequence number received in order.
+         */
+        [[nodiscard]] MessageID cumulative() const { return advanceSequence(expected, limit - 1, limit); }
+
+        /**
+         * @brief Gets the frames received after a gap, bit `i` stands for the sequence number `cumulative() + 1 + i`.
+         */
+        [[nodiscard]] uint32_t selective() const { return received; }
+
+        [[nodiscard]] MessageID sequenceLimit() const { return limit; } ///< Gets the last sequence number
+
+    private:
+        uint32_t received  = 0; ///< Bit `i` is set if the frame `expected + i` was received, bit 0 is always clear
+        MessageID expected = 1; ///< The sequence number of the first missing frame
+        MessageID limit;        ///< The last sequence number
+    };
+} // namespace bpa
+
+#endif // BPA_SLIDING_WINDOW_H
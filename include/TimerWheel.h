@@ -0,0 +1,219 @@
+#ifndef BPA_TIMER_WHEEL_H
+#define BPA_TIMER_WHEEL_H
+
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @class TimerWheel
+     * @brief Hashed timer wheel with a fixed number of timers.
+     *
+     * Each timer is hashed into the slot of its deadline, the wheel visits only the slots elapsed since the last
+     * call to advance(). A slot may hold timers of later rotations, they stay in place until their deadline. Adding,
+     * rescheduling and removing a timer take constant time and nothing is allocated on the heap.
+     *
+     * A timer carries a kind and a key chosen by the owner (e.g. a device ID), they are passed back on expiry.
+     *
+     * @tparam TTimers The maximum number of timers, less than 255.
+     * @tparam TSlots The number of slots of the wheel.
+     * @tparam TResolution The time covered by a slot, in milliseconds.
+     */
+    template<size_t TTimers, size_t TSlots, TimeStamp TResolution>
+    class TimerWheel {
+    public:
+        static_assert(TTimers > 0 && TTimers < 255, "The number of timers should be between 1 and 254");
+        static_assert(TSlots > 0 && TResolution > 0, "The wheel should have slots with a resolution");
+
+        static constexpr uint8_t NONE = 0xFF; ///< Timer index meaning no timer
+
+        /**
+         * @brief Creates a wheel without timers.
+         */
+        TimerWheel() {
+            for (size_t i = 0; i < TTimers; i++) {
+                timers[i].next = static_cast<uint8_t>(i + 1 < TTimers ? i + 1 : NONE);
+            }
+            for (auto& head: slots) {
+                head = NONE;
+            }
+        }
+
+        /**
+         * @brief Adds a timer.
+         * @param kind The kind of the timer, passed back on expiry.
+         * @param key The key of the timer, passed back on expiry.
+         * @param deadline The time at which the timer expires.
+         * @return The index of the timer, or NONE if all timers are in use.
+         */
+        uint8_t add(const uint8_t kind, const uint8_t key, const TimeStamp deadline) {
+            const auto timer = unused;
+            if (timer == NONE) {
+                return NONE;
+            }
+
+            unused              = timers[timer].next;
+            timers[timer].kind  = kind;
+            timers[timer].key   = key;
+            timers[timer].state = IDLE;
+            schedule(timer, deadline);
+            return timer;
+        }
+
+        /**
+         * @brief Moves a timer to a new deadline.
+         * @param timer The index of the timer.
+         * @param deadline The time at which the timer expires.
+         */
+        void schedule(const uint8_t timer, const TimeStamp deadline) {
+            unlink(timer);
+            auto slot = slotOf(current);
+            if (static_cast<long>(deadline - current) > 0) {
+                slot = slotOf(deadline);
+            }
+
+            auto& node    = timers[timer];
+            node.deadline = deadline;
+            node.state    = static_cast<uint8_t>(slot);
+            node.prev     = NONE;
+            node.next     = slots[slot];
+            if (node.next != NONE) {
+                timers[node.next].prev = timer;
+            }
+            slots[slot] = timer;
+        }
+
+        /**
+         * @brief Moves a timer to an earlier deadline, a timer which expires sooner is not changed.
+         * @param timer The index of the timer.
+         * @param deadline The time at which the timer should expire at the latest.
+         */
+        void expireBy(const uint8_t timer, const TimeStamp deadline) {
+            if (timers[timer].state == IDLE || static_cast<long>(deadline - timers[timer].deadline) < 0) {
+                schedule(timer, deadline);
+            }
+        }
+
+        /**
+         * @brief Removes a timer, the index can be reused by add().
+         * @param timer The index of the timer.
+         */
+        void remove(const uint8_t timer) {
+            unlink(timer);
+            timers[timer].state = UNUSED;
+            timers[timer].next  = unused;
+            unused              = timer;
+        }
+
+        /**
+         * @brief Calls the callback of every timer whose deadline has passed.
+         *
+         * An expired timer is not scheduled anymore, the callback can reschedule or remove it.
+         *
+         * @param now The current timestamp.
+         * @param expired Called with the index, the kind and the key of every expired timer.
+         * @return The number of expired timers.
+         */
+        template<typename TCallback>
+        size_t advance(const TimeStamp now, TCallback&& expired) {
+            auto elapsed = now / TResolution - current / TResolution;
+            elapsed      = elapsed < TSlots ? elapsed : TSlots - 1;
+            auto slot    = slotOf(current);
+            current      = now;
+
+            size_t count = 0;
+            for (size_t i = 0; i <= elapsed; i++, slot = (slot + 1) % TSlots) {
+                // Timers rescheduled by the callback go to the fresh list of the slot, not to the one being visited.
+                // The callback may also remove timers which are not visited yet.
+                visiting    = slots[slot];
+                slots[slot] = NONE;
+                for (auto timer = visiting; timer != NONE; timer = timers[timer].next) {
+                    timers[timer].state = VISITING;
+                }
+
+                while (visiting != NONE) {
+                    const auto timer = visiting;
+                    unlink(timer);
+                    if (static_cast<long>(now - timers[timer].deadline) >= 0) {
+                        expired(timer, timers[timer].kind, timers[timer].key);
+                        count++;
+                    }
+                    else {
+                        schedule(timer, timers[timer].deadline);
+                    }
+                }
+            }
+            return count;
+        }
+
+        /**
+         * @brief Gets the earliest deadline of the scheduled timers, visiting every timer.
+         * @param fallback The value returned when no timer is scheduled.
+         */
+        [[nodiscard]] TimeStamp nextExpiry(const TimeStamp fallback) const {
+            auto earliest = fallback;
+            bool found    = false;
+            for (const auto& timer: timers) {
+                if (timer.state < TSlots && (!found || static_cast<long>(timer.deadline - earliest) < 0)) {
+                    earliest = timer.deadline;
+                    found    = true;
+                }
+            }
+            return earliest;
+        }
+
+        /**
+         * @brief Gets the deadline of a timer.
+         */
+        [[nodiscard]] TimeStamp deadline(const uint8_t timer) const { return timers[timer].deadline; }
+
+    private:
+        static_assert(TSlots < 253, "The slot index should fit the state of a timer");
+
+        static constexpr uint8_t VISITING = 0xFD; ///< State of a timer in the slot visited by advance()
+        static constexpr uint8_t IDLE     = 0xFE; ///< State of a timer which is in use but not scheduled
+        static constexpr uint8_t UNUSED   = 0xFF; ///< State of a free timer
+
+        /**
+         * @brief A timer, linked into the list of its slot.
+         */
+        struct Timer {
+            TimeStamp deadline = 0;      ///< The time at which the timer expires
+            uint8_t prev       = NONE;   ///< The previous timer in the slot
+            uint8_t next       = NONE;   ///< The next timer in the slot, or the next free timer
+            uint8_t state      = UNUSED; ///< The slot of the timer, VISITING, IDLE or UNUSED
+            uint8_t kind       = 0;      ///< The kind of the timer
+            uint8_t key        = 0;      ///< The key of the timer
+        };
+
+        static size_t slotOf(const TimeStamp time) { return time / TResolution % TSlots; }
+
+        /**
+         * @brief Removes a timer from the list of its slot, if it is scheduled.
+         */
+        void unlink(const uint8_t timer) {
+            auto& node = timers[timer];
+            if (node.state >= TSlots && node.state != VISITING) {
+                return;
+            }
+
+            if (node.prev != NONE) {
+                timers[node.prev].next = node.next;
+            }
+            else {
+                (node.state == VISITING ? visiting : slots[node.state]) = node.next;
+            }
+            if (node.next != NONE) {
+                timers[node.next].prev = node.prev;
+            }
+            node.state = IDLE;
+        }
+
+        Timer timers[TTimers]{};  ///< The timers
+        uint8_t slots[TSlots]{};  ///< The first timer of each slot
+        uint8_t unused    = 0;    ///< The first free timer
+        uint8_t visiting  = NONE; ///< The first timer of the slot visited by advance()
+        TimeStamp current = 0;    ///< The time of the last call to advance()
+    };
+} // namespace bpa
+
+#endif // BPA_TIMER_WHEEL_H
@@ -0,0 +1,84 @@
+#ifndef BPA_TOKEN_BUCKET_H
+#define BPA_TOKEN_BUCKET_H
+
+#include <algorithm>
+#include "common.h"
+
+namespace bpa {
+    /**
+     * @class TokenBucket
+     * @brief Rate limiter allowing bursts, one token stands for one byte.
+     *
+     * The bucket fills at a fixed rate up to its burst size. Tokens are kept in thousandths, so a rate in bytes per
+     * second fills them by exactly `rate` per millisecond. A full bucket allows any amount, so a burst smaller than a
+     * frame does not block it forever. A bucket with a rate of 0 is unlimited.
+     */
+    class TokenBucket {
+    public:
+        /**
+         * @brief Creates an unlimited bucket.
+         */
+        TokenBucket() = default;
+
+        /**
+         * @brief Changes the rate and the burst size, the bucket starts full.
+         * @param rate The number of bytes per second, 0 for no limit.
+         * @param burst The largest number of bytes taken at once.
+         * @param now The current timestamp.
+         */
+        void configure(const uint32_t rate, const uint32_t burst, const TimeStamp now) {
+            bytesPerSecond = rate;
+            capacity       = static_cast<uint64_t>(burst) * 1000;
+            tokens         = capacity;
+            updated        = now;
+        }
+
+        /**
+         * @brief Checks if the given number of bytes can be taken now.
+         */
+        [[nodiscard]] bool allows(const size_t bytes, const TimeStamp now) {
+            refill(now);
+            return bytesPerSecond == 0 || tokens >= static_cast<uint64_t>(bytes) * 1000 || tokens == capacity;
+        }
+
+        /**
+         * @brief Takes the given number of bytes, the bucket empties if it holds fewer.
+         */
+        void take(const size_t bytes, const TimeStamp now) {
+            refill(now);
+            const auto amount = static_cast<uint64_t>(bytes) * 1000;
+            tokens            = tokens > amount ? tokens - amount : 0;
+        }
+
+        /**
+         * @brief Gets the time in milliseconds until the given number of bytes can be taken.
+         */
+        [[nodiscard]] TimeStamp waitFor(const size_t bytes, const TimeStamp now) {
+            if (allows(bytes, now)) {
+                return 0;
+            }
+            const auto missing = std::min(static_cast<uint64_t>(bytes) * 1000, capacity) - tokens;
+            return static_cast<TimeStamp>((missing + bytesPerSecond - 1) / bytesPerSecond);
+        }
+
+        [[nodiscard]] bool limited() const { return bytesPerSecond != 0; } ///< Checks if the bucket limits the rate
+
+    private:
+        void refill(const TimeStamp now) {
+            const auto elapsed = static_cast<uint64_t>(now - updated);
+            updated            = now;
+            if (bytesPerSecond != 0) {
+                // The product cannot overflow once the bucket is known to be full
+                tokens = elapsed > capacity / bytesPerSecond ? capacity
+                                                             : std::min(capacity, tokens + elapsed * bytesPerSecond);
+            }
+        }
+
+        uint64_t tokens         = 0; ///< The available bytes in thousandths
+        uint64_t capacity       = 0; ///< The burst size in thousandths
+        uint32_t bytesPerSecond = 0; ///< The rate, 0 for no limit
+        TimeStamp updated       = 0; ///< The time of the last refill
+    };
+} // namespace bpa
+
+#endif // BPA_TOKEN_BUCKET_H
@@ -5,6 +5,14 @@
 #include "common.h"
 #include "BinaryMessage.h"
 #include "BinaryTunnel.h"
+#include "FrameBatch.h"
+#include "Fragmentation.h"
+#include "Compression.h"
+#include "DeviceTable.h"
+#include "SlidingWindow.h"
+#include "TimerWheel.h"
+#include "RttEstimator.h"
+#include "TokenBucket.h"
 #include <map>
 #include <utility>
 
@@ -15,6 +23,171 @@
 namespace bpa::udp {
 #define UDP_DEVICE_INFO_TYPE 0x01 ///< The type of the UdpDeviceInfo
 
+#ifndef BPA_UDP_CHECKSUM
+    /**
+     * @brief The integrity policy of the frames sent over UDP (see Checksum.h).
+     * Define it as bpa::NoChecksum to drop the frame trailer on links which already verify the integrity.
+     */
+#define BPA_UDP_CHECKSUM bpa::Fnv1aHash16
+#endif
+
+#ifndef BPA_UDP_MAX_DATAGRAM_SIZE
+    /**
+     * @brief The maximum size of a datagram. Frames queued for the same device are packed into one datagram up to this size.
+     */
+#define BPA_UDP_MAX_DATAGRAM_SIZE 512
+#endif
+
+#ifndef BPA_UDP_OUTGOING_DATAGRAMS
+    /**
+     * @brief The number of datagrams (i.e. destinations) which can be assembled at the same time.
+     */
+#define BPA_UDP_OUTGOING_DATAGRAMS 4
+#endif
+
+#ifndef BPA_UDP_MAX_DEVICES
+    /**
+     * @brief The maximum number of connected devices. Handshakes with further devices are rejected.
+     */
+#define BPA_UDP_MAX_DEVICES 8
+#endif
+
+#ifndef BPA_UDP_MAX_PENDING_HANDSHAKES
+    /**
+     * @brief The maximum number of handshakes in progress. Further handshakes are rejected until one completes or expires.
+     */
+#define BPA_UDP_MAX_PENDING_HANDSHAKES 4
+#endif
+
+#ifndef BPA_UDP_TIMER_RESOLUTION
+    /**
+     * @brief The resolution of the timeouts in milliseconds, the timer wheel covers 64 times this value per rotation.
+     */
+#define BPA_UDP_TIMER_RESOLUTION 16
+#endif
+
+#ifndef BPA_UDP_WINDOW_SIZE
+    /**
+     * @brief The maximum number of unacknowledged frames per device, at most 32. A message is rejected with the
+     * SEND_WINDOW_FULL error when its frames do not fit.
+     */
+#define BPA_UDP_WINDOW_SIZE 16
+#endif
+
+#ifndef BPA_UDP_KEEPALIVE_MIN
+    /**
+     * @brief The shortest interval in milliseconds between two pings to a silent device. It is announced in the
+     * handshake, the other device does not ping this one more often.
+     */
+#define BPA_UDP_KEEPALIVE_MIN BPA_PING_FREQUENCY
+#endif
+
+#ifndef BPA_UDP_KEEPALIVE_MAX
+    /**
+     * @brief The longest interval in milliseconds between two pings to a silent device, reached while no frame to it is
+     * lost.
+     */
+#define BPA_UDP_KEEPALIVE_MAX 4000
+#endif
+
+#ifndef BPA_UDP_INITIAL_CWND
+    /**
+     * @brief The congestion window of a new device, the number of message frames in flight before the first loss.
+     */
+#define BPA_UDP_INITIAL_CWND BPA_UDP_WINDOW_SIZE
+#endif
+
+#ifndef BPA_UDP_ACK_DELAY
+    /**
+     * @brief The time in milliseconds a received frame may wait for its acknowledgement, so that one ACKNOWLEDGE frame
+     * covers the frames received meanwhile. 0 acknowledges every received datagram.
+     */
+#define BPA_UDP_ACK_DELAY 20
+#endif
+
+#ifndef BPA_UDP_ACK_FRAMES
+    /**
+     * @brief The number of received frames which are acknowledged without waiting for BPA_UDP_ACK_DELAY.
+     */
+#define BPA_UDP_ACK_FRAMES 8
+#endif
+
+#ifndef BPA_UDP_RETRANSMIT_SLOTS
+    /**
+     * @brief The number of frames, shared by all devices, whose payload is kept for retransmission in reliable mode.
+     * A message is rejected with the SEND_WINDOW_FULL error when its frames do not fit.
+     */
+#define BPA_UDP_RETRANSMIT_SLOTS 8
+#endif
+
+#ifndef BPA_UDP_QUEUE_SLOTS
+    /**
+     * @brief The number of message frames, shared by all devices, which can wait for the rate limits. A message is
+     * rejected with the SEND_WINDOW_FULL error when its frames do not fit.
+     */
+#define BPA_UDP_QUEUE_SLOTS 8
+#endif
+
+#ifndef BPA_UDP_MAX_RETRANSMITS
+    /**
+     * @brief The number of times a frame is retransmitted in reliable mode before the DELIVERY_FAILED error.
+     */
+#define BPA_UDP_MAX_RETRANSMITS 4
+#endif
+
+#ifndef BPA_UDP_MIN_RTO
+    /**
+     * @brief The lower bound of the retransmission timeout in milliseconds.
+     */
+#define BPA_UDP_MIN_RTO 50
+#endif
+
+#ifndef BPA_UDP_MAX_RTO
+    /**
+     * @brief The upper bound of the retransmission timeout in milliseconds, backoff included.
+     */
+#define BPA_UDP_MAX_RTO 4000
+#endif
+
+#ifndef BPA_UDP_EXTENDED_SEQUENCE
+    /**
+     * @brief Offers 16-bit sequence numbers, carried in extended frame headers, during the handshake. They are used
+     * with devices which offer them too. Set it to 0 on constrained devices to keep the basic 8-bit header.
+     */
+#define BPA_UDP_EXTENDED_SEQUENCE 1
+#endif
+
+#ifndef BPA_UDP_LOOP_PACKET_BUDGET
+    /**
+     * @brief The maximum number of datagrams read by a single loop() call before the maintenance runs.
+     */
+#define BPA_UDP_LOOP_PACKET_BUDGET 8
+#endif
+
+#ifndef BPA_UDP_LOOP_TIME_BUDGET
+    /**
+     * @brief The time in milliseconds after which loop() stops reading datagrams. At least one datagram is read.
+     */
+#define BPA_UDP_LOOP_TIME_BUDGET 5
+#endif
+
+#ifndef BPA_UDP_COMPRESSION
+    /**
+     * @brief Enables the compression of the messages sent to devices which negotiated it during the handshake.
+     * Set it to 0 to neither offer nor use compression. Received messages are decompressed into a slot of the message
+     * pool, so it is disabled by default when BPA_MESSAGE_POOL_SLOTS is 0.
+     */
+#define BPA_UDP_COMPRESSION (BPA_MESSAGE_POOL_SLOTS > 0)
+#endif
+
+    /**
+     * @brief The outcome of a UDPTunnel::loop() call.
+     */
+    struct LoopResult {
+        size_t packets;   ///< The number of datagrams read
+        bool morePending; ///< True if the budget ran out while a datagram was waiting
+    };
+
     /**
      * @brief Class representing information about a device.
      */
@@ -53,23 +226,16 @@ namespace bpa::udp {
      * @brief Namespace containing internal types.
      */
     namespace internal {
-#define UDP_CONNECTED_DEVICE_TYPE 0x02 ///< The type of the ConnectedDevice
-
-        class ConnectedDevice final : public UdpDeviceInfo {
-        public:
-            static constexpr uint8_t TYPE = UDP_CONNECTED_DEVICE_TYPE; ///< The type of the ConnectedDevice
-
-            ConnectedDevice(IPAddress ip, const uint16_t port) : UdpDeviceInfo(std::move(ip), port), lastSeen(0),
-                                                                 lastUpdated(0),
-                                                                 state(DISCONNECTED), countOfErrors(0), countOfLost(0) {
-            }
-
-            ~ConnectedDevice() override = default;
-
+        /**
+         * @brief The record of a connected device, stored by value in the device table.
+         */
+        struct ConnectedDevice {
+            IPAddress ip;          ///< The IP address of the device
+            uint16_t port;         ///< The port number of the device
             TimeStamp lastSeen;    ///< The timestamp of the last seen message from the device
             TimeStamp lastUpdated; ///< The timestamp of the last update by the tunnel
-            TimeStamp lastPing{};  ///< The timestamp of the last ping
-            enum State {
+            TimeStamp lastPing;    ///< The timestamp of the last ping
+            enum State : uint8_t {
                 CONNECTED,
                 LOST,
                 DISCONNECTED
@@ -77,32 +243,131 @@ namespace bpa::udp {
 
             uint8_t countOfErrors; ///< The number of errors received from the device
             uint8_t countOfLost;   ///< The number of lost packets received from the device
+            uint8_t capabilities;  ///< The capabilities supported by both devices (see Capability)
+            uint8_t extensions;    ///< The extended capabilities supported by both devices (see Extension)
+            uint8_t timer;         ///< The timer running the maintenance of the device
+            uint8_t pendingAcks;   ///< The number of received frames not acknowledged yet, BPA_UDP_ACK_FRAMES at most
+            TimeStamp ackDeadline; ///< The time at which the received frames are acknowledged at the latest
+            uint16_t keepalive;    ///< The current interval between two pings to the device while it is silent
+            uint16_t keepaliveMin; ///< The shortest keepalive interval, the longer one requested by both devices
+            uint16_t keepaliveMax; ///< The longest keepalive interval
+            uint8_t queueHead;     ///< The first message frame waiting for the rate limits
+            uint8_t queueTail;     ///< The last message frame waiting for the rate limits
+            uint8_t queued;        ///< The number of message frames waiting for the rate limits
+            uint8_t cwnd;          ///< The congestion window, the number of frames allowed in flight
+            uint8_t cwndAcked;     ///< The number of frames acknowledged since the window last grew
+            MessageID recovery;    ///< The first frame whose loss shrinks the window again
 
-            [[nodiscard]] uint8_t type() override {
-                return UDP_CONNECTED_DEVICE_TYPE;
-            }
+            SendWindow<BPA_UDP_WINDOW_SIZE> sent; ///< The frames sent to the device and not acknowledged yet
+            ReceiveWindow received;               ///< The frames received from the device
+            RttEstimator rtt;                     ///< The round-trip time to the device
+            TokenBucket pacing;                   ///< The rate limit of the message frames sent to the device
         };
 
-        struct PacketInfo {
-            TimeStamp timestamp; ///< The timestamp of the packet
-            DeviceID device_id;  ///< The ID of the device
+        using SentFrame = SendWindow<BPA_UDP_WINDOW_SIZE>::Frame; ///< A frame in flight
+
+        /**
+         * @brief The payload of a frame kept for retransmission in reliable mode.
+         */
+        struct RetransmitBuffer {
+            bool used;               ///< True while the frame is in flight
+            StartByte start;         ///< The start byte of the frame
+            uint8_t size;            ///< The size of the payload
+            uint8_t data[UINT8_MAX]; ///< The payload
+        };
+
+        /**
+         * @brief A message frame waiting for the rate limits or the congestion window, queued per device.
+         */
+        struct QueuedFrame {
+            bool used;               ///< True while the frame is queued
+            uint8_t next;            ///< The next frame queued for the same device
+            StartByte start;         ///< The start byte of the frame
+            uint8_t size;            ///< The size of the payload
+            uint8_t data[UINT8_MAX]; ///< The payload
+        };
+
+        constexpr uint8_t NO_FRAME = 0xFF; ///< Index of a queued frame meaning no frame
+
+        /**
+         * @brief A message being sent to one or more devices, compressed at most once for all of them.
+         */
+        struct OutgoingMessage {
+            uint8_t* data;                 ///< The message
+            MessageSize size;              ///< The size of the message
+            uint8_t transfer;              ///< The transfer ID of the fragments of a large message
+            bool packed;                   ///< True once the compression was tried
+            uint8_t compressedSize;        ///< The size of the compressed message, 0 if it is not smaller
+            uint8_t compressed[UINT8_MAX]; ///< The compressed message
         };
 
         struct HandshakeInfo {
-            IPAddress ip;        ///< The IP address of the device
-            uint16_t port;       ///< The port number of the device
-            TimeStamp timestamp; ///< The timestamp of the handshake
+            IPAddress ip;         ///< The IP address of the device
+            uint16_t port;        ///< The port number of the device
+            TimeStamp timestamp;  ///< The timestamp of the handshake
+            uint8_t capabilities; ///< The capabilities announced by the device (0 until it answered)
+            uint8_t timer;        ///< The timer expiring the handshake
+            uint16_t keepalive;   ///< The shortest keepalive interval requested by the device (0 if not announced)
+            uint8_t extensions;   ///< The extended capabilities announced by the device (see Extension)
+        };
+
+        /**
+         * @brief The kinds of timers of the tunnel, the key of a timer is the device ID or the handshake seed.
+         */
+        enum TimerKind : uint8_t {
+            TIMER_DEVICE,    ///< Lost packets, ping, stale and disconnect timeouts of a device
+            TIMER_HANDSHAKE, ///< Expiry of a pending handshake
+        };
+
+        constexpr size_t TIMER_SLOTS = 64; ///< The number of slots of the timer wheel
+
+        /**
+         * @brief A datagram being assembled for a single destination.
+         */
+        struct OutgoingDatagram {
+            IPAddress ip;                                                    ///< The IP address of the destination
+            uint16_t port;                                                   ///< The port number of the destination
+            FrameBatch<BPA_UDP_MAX_DATAGRAM_SIZE, BPA_UDP_CHECKSUM> frames; ///< The frames queued for the destination
         };
 
-        enum HandshakeByte {
-            HANDSHAKE_INIT     = 0x3C, ///< Handshake init start byte
-            HANDSHAKE_RESP     = 0x3E, ///< Handshake response start byte
-            HANDSHAKE_COMPLETE = 0x2E  ///< Handshake complete start byte
+        /**
+         * @brief Layout of the first byte of a handshake payload.
+         *
+         * The low nibble holds the protocol version, the high nibble holds the optional features supported by the
+         * sender. A feature is used only if both devices announced it.
+         */
+        enum Capability : uint8_t {
+            VERSION_MASK             = 0x0F, ///< Mask of the protocol version
+            CAPABILITY_COMPRESSION   = 0x10, ///< The device understands COMPRESSED_V1 frames
+            CAPABILITY_SELECTIVE_ACK = 0x20, ///< The device understands ACKNOWLEDGE frames
+            CAPABILITY_KEEPALIVE     = 0x40, ///< The handshake carries the shortest keepalive interval of the device
+            CAPABILITY_GROUP         = 0x80, ///< The device understands GROUP_V1 frames
         };
+
+        /**
+         * @brief The capabilities announced by this device.
+         */
+        constexpr uint8_t LOCAL_CAPABILITIES = CAPABILITY_SELECTIVE_ACK | CAPABILITY_KEEPALIVE | CAPABILITY_GROUP |
+                                               (BPA_UDP_COMPRESSION ? CAPABILITY_COMPRESSION : 0);
+
+        /**
+         * @brief Layout of the sixth byte of a handshake payload, the optional features beyond the first byte.
+         */
+        enum Extension : uint8_t {
+            EXTENSION_SEQUENCE_16 = 0x01, ///< The device numbers its frames with 16 bits, in extended headers
+        };
+
+        /**
+         * @brief The extended capabilities announced by this device.
+         */
+        constexpr uint8_t LOCAL_EXTENSIONS = BPA_UDP_EXTENDED_SEQUENCE ? EXTENSION_SEQUENCE_16 : 0;
     };
 
     /**
      * @brief The UDPTunnel class provides a high-level interface for sending and receiving binary messages over UDP.
+     *
+     * All buffers are members, about 17 KB with the default settings, see the Memory section of the README for the
+     * settings which size them.
      */
     class UDPTunnel final : public Tunnel {
     public:
@@ -112,7 +377,7 @@ namespace bpa::udp {
          * @param udp The UDP instance to use for communication.
          * @param id The device ID to use for communication.
          */
-        UDPTunnel(UDP& udp, const DeviceID id) : Tunnel(id), udp(udp), io(udp), messageCounter(0) {
+        UDPTunnel(UDP& udp, const DeviceID id) : Tunnel(id), udp(udp), messageCounter(0), transferCounter(0) {
         };
 
         /**
@@ -122,14 +387,112 @@ namespace bpa::udp {
 
         /**
          * @copydoc Tunnel::sendMessage()
+         *
+         * All fragments of a message are queued at once, each of them is confirmed by the recipient. Frames beyond the
+         * congestion window or the rate limits wait in a queue. The message is rejected with SEND_WOULD_BLOCK and the
+         * SEND_WINDOW_FULL error if its frames do not fit in the send window of the device or in the queue.
          */
-        void sendMessage(DeviceID to, uint8_t* buffer, uint8_t size) override;
+        SendResult sendMessage(DeviceID to, uint8_t* buffer, MessageSize size) override;
+
+        /**
+         * @copydoc Tunnel::sendToGroup()
+         *
+         * The message is compressed at most once for all recipients. If a group address is set, the recipients which
+         * support it and can take a frame right away share a single GROUP_V1 frame sent to that address: it lists the
+         * sequence number of the message for each of them, so each recipient acknowledges its own copy and a lost one
+         * is handled (and retransmitted in reliable mode) for that recipient alone. Other recipients, and messages
+         * larger than a frame, get their own frames.
+         */
+        size_t sendToGroup(const DeviceID* to, size_t count, uint8_t* buffer, MessageSize size) override;
+
+        /**
+         * @copydoc Tunnel::broadcast()
+         */
+        size_t broadcast(uint8_t* buffer, MessageSize size) override;
+
+        /**
+         * @brief Sets the address of the GROUP_V1 frames sent by sendToGroup() and broadcast().
+         *
+         * It can be the broadcast address of the subnet, or a multicast group joined by the devices (e.g. with
+         * `WiFiUDP::beginMulticast()`). Every device which receives the frame delivers the message only if it is
+         * listed in it.
+         *
+         * @param ip The IP address of the group.
+         * @param port The port number of the group, 0 to send every recipient its own frames.
+         */
+        void setGroupAddress(const IPAddress& ip, uint16_t port);
 
         /**
          * @copydoc Tunnel::loop()
+         *
+         * Reads up to `BPA_UDP_LOOP_PACKET_BUDGET` datagrams or for `BPA_UDP_LOOP_TIME_BUDGET` milliseconds.
          */
         void loop() override;
 
+        /**
+         * @brief Reads the received datagrams within a budget, then runs the maintenance once.
+         *
+         * Every message is delivered to the onMessageReceived callbacks as soon as its datagram is read. Frames queued
+         * during the call are packed into one datagram per destination and sent at the end of it. Only the timeouts
+         * which expired since the last call are processed.
+         *
+         * @param packetBudget The maximum number of datagrams to read, at least one is read if available.
+         * @param timeBudget The time in milliseconds after which no further datagram is read.
+         * @return The number of datagrams read and whether more are waiting.
+         */
+        LoopResult loop(size_t packetBudget, TimeStamp timeBudget);
+
+        /**
+         * @brief Enables or disables the reliable delivery of messages.
+         *
+         * In reliable mode the payload of every message frame is kept until the frame is acknowledged. A frame which
+         * is not acknowledged within the retransmission timeout of the device (derived from the measured round-trip
+         * time) is sent again, with the timeout doubled after every attempt. The DELIVERY_FAILED error is triggered
+         * when the frame was sent `BPA_UDP_MAX_RETRANSMITS` more times without an acknowledgement. Otherwise frames are
+         * sent once and counted as lost after `BPA_LOST_PACKET_TIMEOUT` milliseconds.
+         *
+         * @param enabled True to retransmit lost frames.
+         */
+        void setReliableDelivery(bool enabled) { reliable = enabled; }
+
+        /**
+         * @brief Limits the rate of the message frames sent to all devices together.
+         *
+         * Frames over the limit wait in a queue drained by loop() and flush(). Control frames (acknowledgements,
+         * pings, handshakes) and retransmissions are never delayed, they only use up the allowance.
+         *
+         * @param bytesPerSecond The number of bytes per second, 0 for no limit.
+         * @param burst The number of bytes which can be sent at once.
+         */
+        void setRateLimit(uint32_t bytesPerSecond, uint32_t burst);
+
+        /**
+         * @brief Limits the rate of the message frames sent to each device, see setRateLimit().
+         *
+         * @param bytesPerSecond The number of bytes per second, 0 for no limit.
+         * @param burst The number of bytes which can be sent at once.
+         */
+        void setDeviceRateLimit(uint32_t bytesPerSecond, uint32_t burst);
+
+        /**
+         * @brief Gets the time of the next timeout of the devices and of the pending handshakes.
+         *
+         * A caller without incoming data can sleep until then. Frames waiting for the rate limits count as a timeout.
+         * If nothing is scheduled the time is `BPA_PING_FREQUENCY` milliseconds from now.
+         *
+         * @return The timestamp of the next timeout.
+         */
+        TimeStamp nextExpiry();
+
+        /**
+         * @brief Sends all queued frames, one datagram per destination. Message frames are sent as far as the rate
+         * limits allow.
+         *
+         * Messages passed to sendMessage() are queued and sent at the end of the next loop(). Call this method to send
+         * them right away.
+         */
+        void flush();
+
         /**
          * @copydoc Tunnel::connect()
          */
@@ -170,12 +533,47 @@ namespace bpa::udp {
         bool isLostDevice(DeviceID id);
 
     private:
+        static_assert(BPA_UDP_MAX_DATAGRAM_SIZE >= BasicBinaryMessageIO<BPA_UDP_CHECKSUM>::MAX_FRAME_SIZE,
+                      "BPA_UDP_MAX_DATAGRAM_SIZE should fit the largest frame");
+        static_assert(BPA_MAX_MESSAGE_SIZE <= MAX_FRAGMENTED_MESSAGE_SIZE,
+                      "BPA_MAX_MESSAGE_SIZE exceeds the largest fragmented message");
+        static_assert(fragmentCount(BPA_MAX_MESSAGE_SIZE) <= BPA_UDP_WINDOW_SIZE,
+                      "BPA_UDP_WINDOW_SIZE should fit all fragments of the largest message");
+        static_assert(fragmentCount(BPA_MAX_MESSAGE_SIZE) <= BPA_UDP_RETRANSMIT_SLOTS,
+                      "BPA_UDP_RETRANSMIT_SLOTS should fit all fragments of the largest message");
+        static_assert(fragmentCount(BPA_MAX_MESSAGE_SIZE) <= BPA_UDP_QUEUE_SLOTS && BPA_UDP_QUEUE_SLOTS < 255,
+                      "BPA_UDP_QUEUE_SLOTS should fit all fragments of the largest message");
+        static_assert(BPA_UDP_INITIAL_CWND > 0 && BPA_UDP_INITIAL_CWND <= BPA_UDP_WINDOW_SIZE,
+                      "BPA_UDP_INITIAL_CWND should be between 1 and BPA_UDP_WINDOW_SIZE");
+        static_assert(BPA_UDP_ACK_DELAY < BPA_UDP_MIN_RTO, "BPA_UDP_ACK_DELAY should be below BPA_UDP_MIN_RTO");
+        static_assert(!BPA_UDP_COMPRESSION || BPA_MESSAGE_POOL_SLOTS > 0,
+                      "BPA_UDP_COMPRESSION needs a message pool slot to decompress into");
+        static_assert(BPA_UDP_ACK_FRAMES > 0 && BPA_UDP_ACK_FRAMES <= UINT8_MAX,
+                      "BPA_UDP_ACK_FRAMES should be between 1 and 255");
+        static_assert(BPA_UDP_KEEPALIVE_MIN > 0 && BPA_UDP_KEEPALIVE_MIN <= BPA_UDP_KEEPALIVE_MAX &&
+                      BPA_UDP_KEEPALIVE_MAX <= UINT16_MAX, "The keepalive interval should fit 16 bits");
+
         UDP& udp; ///< The UDP instance used for communication
-        BinaryMessageIO io; ///< The BinaryMessageIO instance used for reading and writing messages
         uint8_t messageCounter; ///< The counter used to generate unique message IDs
-        std::map<DeviceID, internal::ConnectedDevice *> connectedDevices; ///< A map containing the connected devices
+        uint8_t transferCounter; ///< The counter used to generate the transfer IDs of fragmented messages
+        uint8_t incoming[BPA_UDP_MAX_DATAGRAM_SIZE]{}; ///< Buffer for the received datagram
+        int parsedPacket = 0; ///< The size of a datagram parsed by the last loop() but not read because of the budget
+        internal::OutgoingDatagram outgoing[BPA_UDP_OUTGOING_DATAGRAMS]{}; ///< Datagrams being assembled
+        ReassemblyPool<BPA_REASSEMBLY_SLOTS, BPA_MAX_MESSAGE_SIZE> reassembly; ///< Fragmented messages being received
+        MessagePool<BPA_MESSAGE_POOL_SLOTS, BPA_MAX_MESSAGE_SIZE> messages; ///< Slots of the received messages
+        DeviceTable<internal::ConnectedDevice, BPA_UDP_MAX_DEVICES> connectedDevices; ///< The connected devices
         std::map<uint8_t, internal::HandshakeInfo> pendingConnections; ///< A map containing the pending connections
-        std::map<MessageID, internal::PacketInfo> pendingPackets; ///< A map containing the pending packets
+        internal::RetransmitBuffer retransmits[BPA_UDP_RETRANSMIT_SLOTS]{}; ///< Payloads kept in reliable mode
+        bool reliable = false; ///< True if lost frames are retransmitted
+        internal::QueuedFrame queue[BPA_UDP_QUEUE_SLOTS]{}; ///< Message frames waiting for the rate limits
+        TokenBucket pacing; ///< The rate limit of the message frames sent to all devices
+        uint32_t deviceRate  = 0; ///< The rate limit of each device in bytes per second, 0 for no limit
+        uint32_t deviceBurst = 0; ///< The burst size of each device
+        uint8_t drainStart   = 0; ///< The device whose queue is drained first, rotated for fairness
+        IPAddress groupIP; ///< The destination of the GROUP_V1 frames
+        uint16_t groupPort = 0; ///< The port number of the GROUP_V1 frames, 0 if none is sent
+        TimerWheel<BPA_UDP_MAX_DEVICES + BPA_UDP_MAX_PENDING_HANDSHAKES, internal::TIMER_SLOTS,
+                   BPA_UDP_TIMER_RESOLUTION> timers; ///< The timeouts of the devices and of the pending handshakes
 
         MessageID generateMessageID();      ///< Generates a unique message ID
         uint8_t generateSeedForHandshake(); ///< Generates a seed for the handshake
@@ -183,10 +581,29 @@ namespace bpa::udp {
         /**
          * @brief Sends a handshake to the specified device with the given byte and seed.
          *
-         * @param byte The handshake byte to send.
+         * The payload holds the protocol version with the local capabilities and the encoded seed.
+         *
+         * @param start The handshake start byte to send.
          * @param seed The seed to use for the handshake.
          */
-        void handshake(internal::HandshakeByte byte, uint8_t seed);
+        void handshake(StartByte start, uint8_t seed);
+
+        /**
+         * @brief Stores a pending handshake and schedules its expiry.
+         *
+         * @param seed The seed of the handshake.
+         * @param info The pending handshake, its timer is set by the method.
+         * @return False if too many handshakes are in progress.
+         */
+        bool addPendingConnection(uint8_t seed, internal::HandshakeInfo info);
+
+        /**
+         * @brief Registers the device which completed the handshake.
+         *
+         * @param deviceId The ID of the device.
+         * @param info The pending handshake with the device.
+         */
+        void handshakeCompleted(DeviceID deviceId, const internal::HandshakeInfo& info);
 
         /**
          * @brief Process the received binary message.
@@ -195,24 +612,286 @@ namespace bpa::udp {
          *
          * @param message The binary message received.
          *
-         * @return Returns true if the message was processed successfully, false otherwise.
+         * @return Returns true if the message is a new input message to deliver, false otherwise.
          */
         bool processReceivedMessage(const BinaryMessage& message);
 
+        /**
+         * @brief Delivers a received message to the onMessageReceived callbacks.
+         *
+         * The payload is copied into a slot of the message pool only if a handle callback is registered.
+         *
+         * @param from The sender of the message.
+         * @param data The payload of the message.
+         * @param size The size of the payload.
+         */
+        void deliverMessage(DeviceID from, uint8_t* data, MessageSize size);
+
+        /**
+         * @brief Delivers a received message stored in a slot of the message pool to the onMessageReceived callbacks.
+         *
+         * @param handle The handle of the message, the handle callback may move it.
+         */
+        void deliverMessage(MessageHandle& handle);
+
+        /**
+         * @brief Decompresses the payload of a COMPRESSED_V1 frame straight into a slot of the message pool and
+         * delivers it. A duplicate is acknowledged again before a slot is taken, it still gets its acknowledgement
+         * while the pool is exhausted.
+         *
+         * @param message The COMPRESSED_V1 message received.
+         */
+        void processCompressed(const BinaryMessage& message);
+
+        /**
+         * @brief Adds a received fragment to its message and delivers the message once it is complete.
+         *
+         * @param message The FRAGMENT_V1 message received.
+         */
+        void processFragment(const BinaryMessage& message);
+
+        /**
+         * @brief Delivers the message of a GROUP_V1 frame if this device is one of its recipients, and acknowledges
+         * the sequence number listed for it.
+         *
+         * @param message The GROUP_V1 message received.
+         */
+        void processGroup(const BinaryMessage& message);
+
         /**
          * @brief Processes an invalid message.
          *
-         * This method is called when an invalid message is received. It logs the status of the invalid message and performs the necessary operations based on the status and message content.
+         * This method is called when an invalid message is received. It logs the status of the invalid message and
+         * answers the sender with the matching error frame.
          *
          * @param status The validation status of the message.
-         * @param message The binary message that was received.
          */
-        void processInvalidMessage(ValidationStatus status, const BinaryMessage& message);
+        void processInvalidMessage(ValidationStatus status);
+
+        /**
+         * @brief Queues a frame for a connected device, the frame is tracked in the send window of the device.
+         *
+         * The sequence number of the frame is used as its message ID, in an extended header if the device uses 16-bit
+         * sequence numbers. In reliable mode the payload of a message frame is kept in a retransmit buffer.
+         *
+         * @param device The record of the device.
+         * @param start The start byte of the message.
+         * @param data The data to be sent.
+         * @param size The size of the data.
+         *
+         * @return The sequence number of the frame, or 0 if the send window is full.
+         */
+        MessageID sendTracked(internal::ConnectedDevice& device, StartByte start, uint8_t* data = nullptr,
+                              uint8_t size = 0);
+
+        /**
+         * @brief Takes the sequence number of a frame sent now to a device, without queueing the frame.
+         *
+         * In reliable mode the payload of a message frame is kept in a retransmit buffer, it is retransmitted with
+         * the given start byte.
+         *
+         * @param device The record of the device.
+         * @param start The start byte of the message.
+         * @param data The payload.
+         * @param size The size of the payload.
+         *
+         * @return The sequence number of the frame, or 0 if the send window is full.
+         */
+        MessageID track(internal::ConnectedDevice& device, StartByte start, uint8_t* data, uint8_t size);
+
+        /**
+         * @brief Checks if a message can be sent to a device, see sendMessage().
+         *
+         * @param to The ID of the device.
+         * @param size The size of the message.
+         * @return SEND_OK if the message fits in the send window and the queue of the device.
+         */
+        SendResult admit(DeviceID to, MessageSize size);
+
+        /**
+         * @brief Sends a message to a connected device, compressed or split into fragments, see submit().
+         *
+         * @param device The record of the device, the message was admitted for it.
+         * @param message The message, it keeps the compressed message for the next recipients.
+         */
+        void submitMessage(internal::ConnectedDevice& device, internal::OutgoingMessage& message);
+
+        /**
+         * @brief Sends a GROUP_V1 frame to the group address.
+         *
+         * @param members The device ID and the sequence number of each recipient.
+         * @param count The number of recipients.
+         * @param data The message.
+         * @param size The size of the message.
+         */
+        void sendGroup(const uint8_t* members, size_t count, const uint8_t* data, uint8_t size);
 
         /**
-         * @brief Sends a binary message to the specified IP address and port number.
+         * @brief Checks if a message frame can be sent to a device now, within its congestion window and the rate
+         * limits.
          *
-         * This method sends a binary message to the specified IP address and port number using the UDP protocol.
+         * @param device The record of the device.
+         * @param size The size of the payload.
+         * @param now The current timestamp.
+         */
+        bool canSend(internal::ConnectedDevice& device, uint8_t size, TimeStamp now);
+
+        /**
+         * @brief Checks if message frames sent to a device now may have to wait in the queue, admit() reserves queue
+         * slots for them. It holds whenever canSend() may fail for a frame which fits the send window.
+         *
+         * @param device The record of the device.
+         * @param frames The number of frames of the message.
+         */
+        [[nodiscard]] bool mayQueue(const internal::ConnectedDevice& device, size_t frames) const;
+
+        /**
+         * @brief Takes a frame from the rate limits, the one of the device and the one of all devices together.
+         *
+         * @param device The record of the device, nullptr for frames sent to devices which are not connected.
+         * @param size The size of the payload.
+         */
+        void charge(internal::ConnectedDevice* device, uint8_t size);
+
+        /**
+         * @brief Grows the congestion window of a device by one frame per window of acknowledged frames.
+         *
+         * @param device The record of the device.
+         */
+        void growWindow(internal::ConnectedDevice& device);
+
+        /**
+         * @brief Halves the congestion window of a device after a loss, once per window of frames.
+         *
+         * @param device The record of the device.
+         * @param sequence The lost frame, losses of frames sent before the last decrease are ignored.
+         */
+        void shrinkWindow(internal::ConnectedDevice& device, MessageID sequence);
+
+        /**
+         * @brief Sends a message frame to a connected device, or queues it until the congestion window and the rate
+         * limits allow it.
+         *
+         * Frames are queued behind the frames already waiting for the device, so they keep their order. admit()
+         * reserves the queue slot, a frame without one is dropped with the SEND_WINDOW_FULL error.
+         *
+         * @param device The record of the device.
+         * @param start The start byte of the message.
+         * @param data The payload, copied if the frame is queued.
+         * @param size The size of the payload.
+         */
+        void submit(internal::ConnectedDevice& device, StartByte start, uint8_t* data, uint8_t size);
+
+        /**
+         * @brief Sends the queued message frames the rate limits allow, starting with a different device every time.
+         */
+        void drainQueues();
+
+        /**
+         * @brief Drops the message frames queued for a device.
+         *
+         * @param device The record of the device.
+         */
+        void clearQueue(internal::ConnectedDevice& device);
+
+        /**
+         * @brief Gets the ID of a connected device from its record.
+         *
+         * @param device The record of the device.
+         * @return The ID of the device, 0 if the record is not in the table.
+         */
+        DeviceID deviceId(const internal::ConnectedDevice& device);
+
+        /**
+         * @brief Gets the number of free queue slots.
+         */
+        [[nodiscard]] size_t freeQueueSlots() const;
+
+        /**
+         * @brief Gets the number of free retransmit buffers.
+         */
+        [[nodiscard]] size_t freeRetransmitBuffers() const;
+
+        /**
+         * @brief Gets the time after which a frame in flight is retransmitted or considered lost.
+         *
+         * @param device The record of the device.
+         * @param frame The frame in flight.
+         */
+        [[nodiscard]] TimeStamp retransmitTimeout(const internal::ConnectedDevice& device,
+                                                  const internal::SentFrame& frame) const;
+
+        /**
+         * @brief Sends the oldest frame in flight to a device again.
+         *
+         * @param device The record of the device.
+         * @param frame The oldest frame in flight, it holds a retransmit buffer.
+         * @param now The current timestamp.
+         */
+        void retransmit(internal::ConnectedDevice& device, internal::SentFrame& frame, TimeStamp now);
+
+        /**
+         * @brief Handles a frame which left the send window of a device: takes a round-trip time sample if it was
+         * acknowledged on the first attempt and frees its retransmit buffer.
+         *
+         * @param device The record of the device.
+         * @param frame The frame which left the window.
+         * @param acknowledged True if the frame was acknowledged, false if it was given up.
+         */
+        void frameCompleted(internal::ConnectedDevice& device, const internal::SentFrame& frame, bool acknowledged);
+
+        /**
+         * @brief Records a frame received from a connected device and schedules its acknowledgement.
+         *
+         * Devices which negotiated CAPABILITY_SELECTIVE_ACK get a single ACKNOWLEDGE frame for the frames received
+         * within `BPA_UDP_ACK_DELAY` milliseconds, or earlier with the next frame sent to them. A gap, a duplicate or
+         * `BPA_UDP_ACK_FRAMES` received frames are acknowledged by the next loop(). Other devices get a CONFIRM frame
+         * carrying the ID of every received frame.
+         *
+         * A duplicate, e.g. a frame resent because its acknowledgement was lost, is acknowledged again but should not
+         * be delivered again. The receive window of the device tells it apart in constant time.
+         *
+         * @param device The record of the device.
+         * @param sequence The message ID of the received frame.
+         * @return True if the frame was not received before.
+         */
+        bool acknowledge(internal::ConnectedDevice& device, MessageID sequence);
+
+        /**
+         * @brief Queues an ACKNOWLEDGE frame with the cumulative and the selective acknowledgement of a device.
+         *
+         * @param device The record of the device.
+         */
+        void sendAcknowledge(internal::ConnectedDevice& device);
+
+        /**
+         * @brief Queues a control frame for a connected device, in the datagram of the other frames sent to it.
+         *
+         * @param device The record of the device.
+         * @param start The basic start byte of the frame, extended if the device negotiated 16-bit sequence numbers.
+         * @param id The message ID of the frame.
+         * @param data The payload of the frame.
+         * @param size The size of the payload.
+         */
+        void sendControl(internal::ConnectedDevice& device, StartByte start, MessageID id, uint8_t* data = nullptr,
+                         uint8_t size = 0);
+
+        /**
+         * @brief Processes an ACKNOWLEDGE frame.
+         *
+         * The payload holds the cumulative acknowledgement followed by up to four bytes of the selective bitmap,
+         * least significant byte first.
+         *
+         * @param device The record of the device.
+         * @param message The ACKNOWLEDGE message received.
+         */
+        void processAcknowledge(internal::ConnectedDevice& device, const BinaryMessage& message);
+
+        /**
+         * @brief Queues a binary message for the specified IP address and port number.
+         *
+         * The message is encoded into the datagram assembled for the destination right away, so the data can be reused
+         * after the call. The datagram is sent by flush().
          *
          * @param ip The IP address of the device.
          * @param port The port number of the device.
@@ -225,55 +904,80 @@ namespace bpa::udp {
         MessageID doSend(IPAddress ip, uint16_t port, StartByte start, uint8_t* data = nullptr, uint8_t size = 0);
 
         /**
-         * @brief Check for lost packets and perform necessary actions.
+         * @brief Appends the message to the datagram assembled for the destination.
+         *
+         * If the datagram is full it is sent first. If there is no free datagram, all queued datagrams are sent.
          *
-         * This method checks for lost packets in the `pendingPackets` container.
-         * If a packet has been pending for longer than `BPA_LOST_PACKET_TIMEOUT` milliseconds,
-         * the packet is considered lost and the corresponding device is notified.
+         * @param ip The IP address of the destination.
+         * @param port The port number of the destination.
+         * @param message The message to be queued.
+         */
+        void enqueue(const IPAddress& ip, uint16_t port, const BinaryMessage& message);
+
+        /**
+         * @brief Sends the datagram if it contains any frames and clears it.
          *
-         * The method iterates over each pending packet and checks its timestamp.
-         * If the difference between the current time and the packet timestamp exceeds
-         * `BPA_LOST_PACKET_TIMEOUT`, the packet is considered lost.
+         * @param datagram The datagram to be sent.
+         */
+        void sendDatagram(internal::OutgoingDatagram& datagram);
+
+        /**
+         * @brief Runs the timers which expired since the last call.
+         */
+        void processTimers();
+
+        /**
+         * @brief Runs the maintenance of a device when its timer expires.
          *
-         * If a packet is lost, a log message is printed using `DEBUG_PRINTF` to indicate
-         * the packet loss, and the `connectedDevice_lostPacket` method is called to
-         * notify the connected device about the lost packet.
+         * The received frames are acknowledged once their acknowledgement is due. Frames which were not
+         * acknowledged within `BPA_LOST_PACKET_TIMEOUT` milliseconds are considered lost, a ping is sent if nothing was
+         * received from the device within its keepalive interval, and the device is marked lost after
+         * `BPA_STALE_TIMEOUT` and disconnected after `BPA_DISCONNECTED_TIMEOUT` milliseconds of silence (at least two
+         * keepalive intervals). The timer is then scheduled at the next deadline of the device.
          *
-         * Finally, the method removes the lost packet from the `pendingPackets` container.
+         * The keepalive interval doubles after every ping sent, up to the longest one, and falls back to the shortest
+         * one when a frame is lost. A ping skipped because the send window is full leaves it as it is.
          *
-         * @note This method uses the `millis()` function to get the current time.
+         * @param deviceId The ID of the device.
          *
-         * @see connectedDevice_lostPacket
          * @see BPA_LOST_PACKET_TIMEOUT
+         * @see BPA_STALE_TIMEOUT
          */
-        void checkForLostPackets();
+        void updateDevice(DeviceID deviceId);
 
         /**
-         * @brief Updates the state of connected devices.
+         * @brief Schedules the timer of a device at its earliest deadline.
          *
-         * This method is responsible for updating the state of connected devices in the UDPTunnel.
-         * It performs the following actions for each connected device:
-         * 1. Checks if the device has been inactive for too long and triggers an error if necessary.
-         * 2. Sends a ping message to the device if it has not been pinged recently.
-         * 3. Disconnects the device if it has lost too many packets or has been inactive for too long.
+         * Deadlines which move later (e.g. when a packet is received) are not tracked, the timer then expires early
+         * and is scheduled again.
          *
-         * @note This method does not return any value.
+         * @param device The record of the device.
          */
-        void updateConnectedDevicesState();
+        void scheduleDevice(internal::ConnectedDevice& device);
 
         /**
-         * @brief Clears stale handshake connections.
+         * @brief Removes a connected device with its timer and its partially received messages.
          *
-         * This method clears any pending handshake connections that have exceeded the stale timeout duration.
-         * It iterates through the map of pendingConnections and checks the timestamp of each connection.
-         * If the current timestamp minus the timestamp of the connection is greater than the stale timeout duration,
-         * the connection is considered stale and removed from the map.
+         * @param deviceId The ID of the device.
+         * @return True if the device was known.
+         */
+        bool removeDevice(DeviceID deviceId);
+
+        /**
+         * @brief Drops a handshake which was not completed within `BPA_STALE_TIMEOUT` milliseconds.
          *
-         * @note This method does not return any value.
+         * @param seed The seed of the handshake.
          *
          * @see BPA_STALE_TIMEOUT
          */
-        void clearStaleHandshakes();
+        void expireHandshake(uint8_t seed);
+
+        /**
+         * @brief Drops fragmented messages which did not receive any fragment for `BPA_REASSEMBLY_TIMEOUT` milliseconds.
+         *
+         * @see BPA_REASSEMBLY_TIMEOUT
+         */
+        void clearStaleFragments();
 
         /**
          * @brief Handles the event when a packet is lost for a connected device.
@@ -308,36 +1012,22 @@ namespace bpa::udp {
         void connectedDevice_receivedPacket(DeviceID id);
 
         /**
-         * @brief Adds a packet to the pendingPackets map.
-         *
-         * This method adds a packet to the pendingPackets map with the given deviceId and message_id. The added packet has a timestamp set to the current millis().
-         *
-         * @param deviceId The ID of the device.
-         * @param message_id The ID of the message packet.
-         */
-        void addPendingPackets(DeviceID deviceId, MessageID message_id);
-
-        /**
-         * @brief Handle the received response for a pending packet.
-         *
-         * This method is responsible for handling the received response for a pending packet.
-         * It removes the packet from the list of pending packets if it exists.
+         * @brief Gets the next received datagram, starting with the one left by the previous loop().
          *
-         * @param message_id The ID of the received response message.
+         * @return The size of the datagram, 0 if no datagram is waiting.
          */
-        void pendingPackets_receivedResponse(MessageID message_id);
+        int nextPacket();
 
         /**
-         * @brief Reads a UDP message from the network.
+         * @brief Reads a parsed UDP datagram from the network.
          *
-         * This method reads a UDP message from the network, processes the message,
-         * and returns the binary message. If the received message is valid, it is
-         * processed using the processReceivedMessage() method. If the message is
-         * invalid, it is processed using the processInvalidMessage() method.
+         * This method reads a datagram from the network and processes every frame packed into it. Valid frames are
+         * processed using the processReceivedMessage() method and delivered to the onMessageReceived callback, invalid
+         * frames are processed using the processInvalidMessage() method.
          *
-         * @return BinaryMessage - The binary message received from the network.
+         * @param packetSize The size of the datagram returned by parsePacket().
          */
-        BinaryMessage _readMessage();
+        void _readPacket(int packetSize);
     };
 }
 
@@ -4,6 +4,18 @@
 #include <cstdint>
 #include <Arduino.h>
 
+// Lookup tables are kept in flash on targets with a separate program memory (pgmspace.h, included by Arduino.h).
+// Elsewhere, e.g. in native test builds, they stay in memory and are read directly.
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(address) (*(address))
+#endif
+#ifndef pgm_read_dword
+#define pgm_read_dword(address) (*(address))
+#endif
+
 namespace bpa {
     /**
      * @brief The version of the Binary Protocol for Arduino.
@@ -53,6 +65,37 @@ namespace bpa {
      * @brief If this number of packets is lost, the device is considered "DISCONNECTED". If set to 0, this feature is disabled.
      */
 #define BPA_DISCONNECT_ON_LOST_N_PACKETS 0
+#endif
+
+#ifndef BPA_MAX_MESSAGE_SIZE
+    /**
+     * @brief The maximum size of a message passed to Tunnel::sendMessage(). Messages which do not fit into a single
+     * frame are fragmented, the receiver reassembles them into buffers of this size.
+     */
+#define BPA_MAX_MESSAGE_SIZE 1024
+#endif
+
+#ifndef BPA_REASSEMBLY_SLOTS
+    /**
+     * @brief The number of fragmented messages which can be reassembled at the same time.
+     */
+#define BPA_REASSEMBLY_SLOTS 2
+#endif
+
+#ifndef BPA_REASSEMBLY_TIMEOUT
+    /**
+     * @brief If no fragment of an incomplete message is received within this timeout, the message is dropped.
+     */
+#define BPA_REASSEMBLY_TIMEOUT 3000
+#endif
+
+#ifndef BPA_MESSAGE_POOL_SLOTS
+    /**
+     * @brief The number of received messages which can be held as MessageHandle at the same time, each slot takes
+     * BPA_MAX_MESSAGE_SIZE bytes. Set it to 0 if only the raw pointer callback is used, the UDP tunnel then neither
+     * offers nor uses compression since it decompresses messages into a slot.
+     */
+#define BPA_MESSAGE_POOL_SLOTS 4
 #endif
 
     /**
@@ -63,9 +106,15 @@ namespace bpa {
 
     /**
      * @typedef MessageID
-     * @brief Type representing the message ID of a binary message.
+     * @brief Type representing the message ID of a binary message, 8 bits wide unless the frame has an extended header.
+     */
+    typedef uint16_t MessageID;
+
+    /**
+     * @typedef MessageSize
+     * @brief Type representing the size of a message passed to a tunnel (it can span several frames).
      */
-    typedef uint8_t MessageID;
+    typedef uint16_t MessageSize;
 
     // Add example below before including this file to enable debug output
     //  #define BPA_DEBUG_ENABLED
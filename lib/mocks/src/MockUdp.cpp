@@ -12,7 +12,7 @@ IPAddress randomIP()
     return {randomByte(), randomByte(), randomByte(), randomByte()};
 }
 
-MockUDP::MockUDP() : remote_ip(randomIP()), remote_port(randomByte()), packet(nullptr), packet_size(0), packet_index(0), packet_ip(0, 0, 0, 0), packet_port(0), write_buffer{0}, write_size(0)
+MockUDP::MockUDP() : remote_ip(randomIP()), remote_port(randomByte()), packet(nullptr), packet_size(0), packet_index(0), packet_parsed(false), packet_queue{}, packet_queue_head(0), packet_queue_size(0), packet_ip(0, 0, 0, 0), packet_port(0), write_buffer{0}, write_size(0), write_calls(0), sent_packet_ends{0}, sent_packet_count(0)
 {
 }
 
@@ -32,12 +32,37 @@ int MockUDP::beginPacket(const char *host, uint16_t port)
 
 int MockUDP::endPacket()
 {
+    if (sent_packet_count < sizeof(sent_packet_ends) / sizeof(sent_packet_ends[0]))
+    {
+        sent_packet_ends[sent_packet_count++] = write_size;
+    }
     return 1;
 }
 
 int MockUDP::parsePacket()
 {
-    return packet_size;
+    if (packet != nullptr && !packet_parsed)
+    {
+        packet_parsed = true;
+        return packet_size;
+    }
+
+    if (packet_queue_head < packet_queue_size)
+    {
+        packet = packet_queue[packet_queue_head].data;
+        packet_size = packet_queue[packet_queue_head].size;
+        packet_index = 0;
+        packet_parsed = true;
+        packet_queue_head++;
+        return packet_size;
+    }
+
+    packet = nullptr;
+    packet_size = 0;
+    packet_index = 0;
+    packet_queue_head = 0;
+    packet_queue_size = 0;
+    return 0;
 }
 
 IPAddress MockUDP::remoteIP()
@@ -53,6 +78,7 @@ uint16_t MockUDP::remotePort()
 size_t MockUDP::write(uint8_t data)
 {
     TEST_MESSAGE("MockUDP::write(uint8_t)");
+    write_calls++;
     if (write_size >= sizeof(write_buffer))
     {
         return 0;
@@ -66,6 +92,7 @@ size_t MockUDP::write(uint8_t data)
 size_t MockUDP::write(const uint8_t *buffer, size_t size)
 {
     TEST_MESSAGE("MockUDP::write(const uint8_t *, size_t)");
+    write_calls++;
     // Write as much as possible
     size_t to_write = sizeof(write_buffer) - write_size;
     if (to_write > size)
@@ -151,6 +178,15 @@ void MockUDP::mock_setPacketToParse(const uint8_t *packet, size_t size)
     this->packet = packet;
     packet_size = size;
     packet_index = 0;
+    packet_parsed = false;
+}
+
+void MockUDP::mock_addPacketToParse(const uint8_t *packet, size_t size)
+{
+    if (packet_queue_size < sizeof(packet_queue) / sizeof(packet_queue[0]))
+    {
+        packet_queue[packet_queue_size++] = {packet, size};
+    }
 }
 
 IPAddress MockUDP::mock_getPacketIP()
@@ -175,6 +211,40 @@ size_t MockUDP::mock_getWroteData(uint8_t *buffer, size_t len)
     return len;
 }
 
+size_t MockUDP::mock_getWriteCalls()
+{
+    return write_calls;
+}
+
+size_t MockUDP::mock_getSentPacketCount()
+{
+    return sent_packet_count;
+}
+
+size_t MockUDP::mock_getSentPacket(size_t index, uint8_t *buffer, size_t len)
+{
+    if (index >= sent_packet_count)
+    {
+        return 0;
+    }
+
+    const size_t begin = index == 0 ? 0 : sent_packet_ends[index - 1];
+    const size_t size = sent_packet_ends[index] - begin;
+    if (len > size)
+    {
+        len = size;
+    }
+
+    memcpy(buffer, write_buffer + begin, len);
+    return len;
+}
+
+void MockUDP::mock_clearSentPackets()
+{
+    write_size = 0;
+    sent_packet_count = 0;
+}
+
 void MockUDP::mock_reset()
 {
     remote_ip = randomIP();
@@ -182,7 +252,12 @@ void MockUDP::mock_reset()
     packet = nullptr;
     packet_size = 0;
     packet_index = 0;
+    packet_parsed = false;
+    packet_queue_head = 0;
+    packet_queue_size = 0;
     packet_ip = IPAddress(0, 0, 0, 0);
     packet_port = 0;
     write_size = 0;
+    write_calls = 0;
+    sent_packet_count = 0;
 }
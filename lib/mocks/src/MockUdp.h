@@ -37,10 +37,15 @@ public:
     void mock_setRemotePort(uint16_t port);
     
     void mock_setPacketToParse(const uint8_t *packet, size_t size);
+    void mock_addPacketToParse(const uint8_t *packet, size_t size);
     IPAddress mock_getPacketIP();
     uint16_t mock_getPacketPort();
 
     size_t mock_getWroteData(uint8_t *buffer, size_t len);
+    size_t mock_getWriteCalls();
+    size_t mock_getSentPacketCount();
+    size_t mock_getSentPacket(size_t index, uint8_t *buffer, size_t len);
+    void mock_clearSentPackets();
     
     void mock_reset();
 private:
@@ -49,11 +54,23 @@ private:
     const uint8_t *packet;
     size_t packet_size;
     size_t packet_index;
+    bool packet_parsed;
+
+    struct QueuedPacket
+    {
+        const uint8_t *data;
+        size_t size;
+    } packet_queue[8];
+    size_t packet_queue_head;
+    size_t packet_queue_size;
 
     IPAddress packet_ip;
     uint16_t packet_port;
-    uint8_t write_buffer[512];
+    uint8_t write_buffer[2048];
     size_t write_size;
+    size_t write_calls;
+    size_t sent_packet_ends[16];
+    size_t sent_packet_count;
 };
 
 #endif // MOCK_UDP_H
\ No newline at end of file
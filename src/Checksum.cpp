@@ -0,0 +1,109 @@
+#include "Checksum.h"
+
+using namespace bpa;
+
+namespace {
+    /**
+     * @brief Lookup table for the CRC-16/CCITT, one entry per value of the most significant byte.
+     */
+    struct Crc16Table {
+        uint16_t values[256];
+
+        constexpr Crc16Table() : values() {
+            for (int i = 0; i < 256; i++) {
+                auto crc = static_cast<uint16_t>(i << 8);
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = crc & 0x8000 ? static_cast<uint16_t>(crc << 1 ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+                }
+                values[i] = crc;
+            }
+        }
+    };
+
+    /**
+     * @brief Lookup tables for the slicing-by-8 CRC-32. Table `k` advances a byte through `k` more zero bytes.
+     */
+    struct Crc32Tables {
+        uint32_t values[8][256];
+
+        constexpr Crc32Tables() : values() {
+            for (int i = 0; i < 256; i++) {
+                auto crc = static_cast<uint32_t>(i);
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = crc & 1 ? crc >> 1 ^ 0xEDB88320 : crc >> 1;
+                }
+                values[0][i] = crc;
+            }
+            for (int i = 0; i < 256; i++) {
+                for (int k = 1; k < 8; k++) {
+                    values[k][i] = values[k - 1][i] >> 8 ^ values[0][values[k - 1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    // In flash, the tables would take 8.5 KB of the RAM of an ESP8266 otherwise
+    constexpr Crc16Table CRC16_TABLE PROGMEM{};
+    constexpr Crc32Tables CRC32_TABLES PROGMEM{};
+
+    uint16_t crc16Entry(const uint8_t index) {
+        return static_cast<uint16_t>(pgm_read_word(&CRC16_TABLE.values[index]));
+    }
+
+    uint32_t crc32Entry(const uint8_t table, const uint8_t index) {
+        return static_cast<uint32_t>(pgm_read_dword(&CRC32_TABLES.values[table][index]));
+    }
+
+    uint32_t readLittleEndian32(const uint8_t* bytes) {
+        return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+    }
+}
+
+void Fnv1aHash16::update(const uint8_t* bytes, size_t length) {
+    uint16_t value = hash;
+    while (length >= 4) {
+        value = (value ^ bytes[0]) * PRIME;
+        value = (value ^ bytes[1]) * PRIME;
+        value = (value ^ bytes[2]) * PRIME;
+        value = (value ^ bytes[3]) * PRIME;
+        bytes += 4;
+        length -= 4;
+    }
+    while (length-- > 0) {
+        value = (value ^ *bytes++) * PRIME;
+    }
+    hash = value;
+}
+
+void Crc16Ccitt::update(const uint8_t byte) {
+    crc = static_cast<uint16_t>(crc << 8) ^ crc16Entry((crc >> 8 ^ byte) & 0xFF);
+}
+
+void Crc16Ccitt::update(const uint8_t* bytes, size_t length) {
+    uint16_t value = crc;
+    while (length-- > 0) {
+        value = static_cast<uint16_t>(value << 8) ^ crc16Entry((value >> 8 ^ *bytes++) & 0xFF);
+    }
+    crc = value;
+}
+
+void Crc32::update(const uint8_t byte) {
+    crc = crc >> 8 ^ crc32Entry(0, (crc ^ byte) & 0xFF);
+}
+
+void Crc32::update(const uint8_t* bytes, size_t length) {
+    uint32_t value = crc;
+    while (length >= 8) {
+        const uint32_t low  = readLittleEndian32(bytes) ^ value;
+        const uint32_t high = readLittleEndian32(bytes + 4);
+        value = crc32Entry(7, low & 0xFF) ^ crc32Entry(6, low >> 8 & 0xFF) ^ crc32Entry(5, low >> 16 & 0xFF) ^
+                crc32Entry(4, low >> 24) ^ crc32Entry(3, high & 0xFF) ^ crc32Entry(2, high >> 8 & 0xFF) ^
+                crc32Entry(1, high >> 16 & 0xFF) ^ crc32Entry(0, high >> 24);
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        value = value >> 8 ^ crc32Entry(0, (value ^ *bytes++) & 0xFF);
+    }
+    crc = value;
+}
@@ -0,0 +1,137 @@
+#include "Compression.h"
+
+using namespace bpa;
+
+namespace {
+    constexpr size_t HASH_BITS     = 6;              ///< Bits of the hash of a 3-byte prefix
+    constexpr size_t HASH_SIZE     = 1 << HASH_BITS; ///< Number of hash chains
+    constexpr uint16_t NO_POSITION = 0xFFFF;         ///< Empty chain link
+    constexpr size_t MAX_CHAIN     = 16;             ///< Candidates checked for each position
+
+    uint8_t hashPrefix(const uint8_t* bytes) {
+        return static_cast<uint8_t>((bytes[0] * 33u ^ bytes[1] * 7u ^ bytes[2]) & (HASH_SIZE - 1));
+    }
+}
+
+size_t bpa::lzCompress(const uint8_t* input, const size_t length, uint8_t* output, const size_t capacity) {
+    if (length == 0 || length > 0xFFFF) {
+        return 0;
+    }
+
+    uint16_t head[HASH_SIZE];
+    uint16_t chain[LZ_WINDOW_SIZE]; // previous position with the same hash, indexed by position % LZ_WINDOW_SIZE
+    for (auto& position: head) {
+        position = NO_POSITION;
+    }
+
+    size_t in       = 0;
+    size_t out      = 0;
+    size_t flagsAt  = 0;
+    uint8_t flagBit = 8;
+
+    const auto insert = [&](const size_t position) {
+        if (position + LZ_MIN_MATCH <= length) {
+            const auto hash                  = hashPrefix(input + position);
+            chain[position % LZ_WINDOW_SIZE] = head[hash];
+            head[hash]                       = static_cast<uint16_t>(position);
+        }
+    };
+
+    while (in < length) {
+        if (flagBit == 8) {
+            if (out >= capacity) {
+                return 0;
+            }
+            flagsAt         = out++;
+            output[flagsAt] = 0;
+            flagBit         = 0;
+        }
+
+        size_t bestLength   = 0;
+        size_t bestDistance = 0;
+        if (in + LZ_MIN_MATCH <= length) {
+            const size_t maxLength = length - in < LZ_MAX_MATCH ? length - in : LZ_MAX_MATCH;
+            auto candidate         = head[hashPrefix(input + in)];
+            for (size_t checked = 0; candidate != NO_POSITION && checked < MAX_CHAIN; checked++) {
+                const size_t distance = in - candidate;
+                if (distance == 0 || distance > LZ_WINDOW_SIZE) {
+                    break;
+                }
+
+                size_t matched = 0;
+                while (matched < maxLength && input[candidate + matched] == input[in + matched]) {
+                    matched++;
+                }
+                if (matched > bestLength) {
+                    bestLength   = matched;
+                    bestDistance = distance;
+                    if (matched == maxLength) {
+                        break;
+                    }
+                }
+
+                const auto previous = chain[candidate % LZ_WINDOW_SIZE];
+                if (previous == NO_POSITION || previous >= candidate) {
+                    break;
+                }
+                candidate = previous;
+            }
+        }
+
+        if (bestLength >= LZ_MIN_MATCH) {
+            if (out + 2 > capacity) {
+                return 0;
+            }
+            output[flagsAt] |= 1 << flagBit;
+            output[out++] = static_cast<uint8_t>(bestDistance - 1);
+            output[out++] = static_cast<uint8_t>(bestLength - LZ_MIN_MATCH);
+            for (size_t i = 0; i < bestLength; i++) {
+                insert(in + i);
+            }
+            in += bestLength;
+        }
+        else {
+            if (out >= capacity) {
+                return 0;
+            }
+            output[out++] = input[in];
+            insert(in);
+            in++;
+        }
+        flagBit++;
+    }
+    return out;
+}
+
+size_t bpa::lzDecompress(const uint8_t* input, const size_t length, uint8_t* output, const size_t capacity) {
+    size_t in  = 0;
+    size_t out = 0;
+    while (in < length) {
+        const uint8_t flags = input[in++];
+        for (uint8_t bit = 0; bit < 8 && in < length; bit++) {
+            if (flags & (1 << bit)) {
+                if (in + 2 > length) {
+                    DEBUG_PRINTLN("lzDecompress() - Truncated back-reference");
+                    return 0;
+                }
+                const size_t distance = input[in++] + 1;
+                const size_t matched  = input[in++] + LZ_MIN_MATCH;
+                if (distance > out || out + matched > capacity) {
+                    DEBUG_PRINTLN("lzDecompress() - Invalid back-reference");
+                    return 0;
+                }
+                // Byte by byte, a back-reference may overlap the bytes it produces
+                for (size_t i = 0; i < matched; i++, out++) {
+                    output[out] = output[out - distance];
+                }
+            }
+            else {
+                if (out >= capacity) {
+                    return 0;
+                }
+                output[out++] = input[in++];
+            }
+        }
+    }
+    return out;
+}
@@ -1,6 +1,7 @@
 #include "UdpTunnel.h"
 #include <Arduino.h>
 
+#include <algorithm>
 #include <utility>
 #include "BinaryMessage.h"
 
@@ -16,81 +17,301 @@ uint8_t decodeSeed(const DeviceID id, const uint16_t encoded) {
     return seed - id % 256;
 }
 
+uint16_t decodeKeepalive(const BinaryMessage& message) {
+    if (!(message.data[0] & udp::internal::CAPABILITY_KEEPALIVE) || message.size < 5) {
+        return 0; // Not announced, the local interval applies
+    }
+    return message.data[3] << 8 | message.data[4];
+}
+
+uint8_t decodeExtensions(const BinaryMessage& message) {
+    return message.size >= 6 ? message.data[5] : 0;
+}
+
+StartByte sequencedStart(const udp::internal::ConnectedDevice& device, const StartByte start) {
+    // The extended header carries the high byte of the sequence number
+    return device.extensions & udp::internal::EXTENSION_SEQUENCE_16 ? extendedStartByte(start) : start;
+}
+
+TimeStamp silenceTimeout(const udp::internal::ConnectedDevice& device, const TimeStamp timeout) {
+    // A device pinged rarely is heard from rarely
+    return std::max(timeout, static_cast<TimeStamp>(2 * device.keepaliveMax));
+}
+
 UdpDeviceInfo::~UdpDeviceInfo() {
     DEBUG_PRINTLN("UdpDeviceInfo::~UdpDeviceInfo()");
 }
 
 UDPTunnel::~UDPTunnel() {
     DEBUG_PRINTLN("UDPTunnel::~UDPTunnel()");
+}
+
+SendResult UDPTunnel::sendMessage(const DeviceID to, uint8_t* buffer, const MessageSize size) {
+    const auto result = admit(to, size);
+    if (result != SEND_OK) {
+        return result;
+    }
+
+    internal::OutgoingMessage message = {buffer, size, size > UINT8_MAX ? transferCounter++ : uint8_t{0}, false, 0, {}};
+    submitMessage(*connectedDevices.find(to), message);
+    return SEND_OK;
+}
+
+size_t UDPTunnel::sendToGroup(const DeviceID* to, const size_t count, uint8_t* buffer, const MessageSize size) {
+    internal::OutgoingMessage message = {buffer, size, size > UINT8_MAX ? transferCounter++ : uint8_t{0}, false, 0, {}};
+    // Each recipient of a GROUP_V1 frame takes three bytes in front of the message
+    const size_t capacity = groupPort != 0 && size <= UINT8_MAX - 4 ? (UINT8_MAX - 1 - size) / 3 : 0;
+    uint8_t members[UINT8_MAX - 1];
+    size_t grouped  = 0;
+    size_t accepted = 0;
+    const auto now  = GET_CURRENT_TIMESTAMP();
+    for (size_t i = 0; i < count; i++) {
+        if (admit(to[i], size) != SEND_OK) {
+            continue;
+        }
+
+        accepted++;
+        auto& device = *connectedDevices.find(to[i]);
+        if (capacity == 0 || !(device.capabilities & internal::CAPABILITY_GROUP) || device.queued > 0 ||
+            !canSend(device, static_cast<uint8_t>(size), now)) {
+            submitMessage(device, message);
+            continue;
+        }
+
+        device.pacing.take(frameLength<BPA_UDP_CHECKSUM>(size), now);
+        const auto sequence      = track(device, START_V1, buffer, static_cast<uint8_t>(size));
+        members[grouped * 3]     = to[i];
+        members[grouped * 3 + 1] = highByte(sequence);
+        members[grouped * 3 + 2] = lowByte(sequence);
+        if (++grouped == capacity) {
+            sendGroup(members, grouped, buffer, static_cast<uint8_t>(size));
+            grouped = 0;
+        }
+    }
+    if (grouped > 0) {
+        sendGroup(members, grouped, buffer, static_cast<uint8_t>(size));
+    }
+    return accepted;
+}
 
-    for (auto& [deviceId, deviceInfo]: connectedDevices) {
-        delete deviceInfo;
+size_t UDPTunnel::broadcast(uint8_t* buffer, const MessageSize size) {
+    DeviceID devices[BPA_UDP_MAX_DEVICES];
+    size_t count = 0;
+    for (size_t i = 0; i < connectedDevices.size(); i++) {
+        if (connectedDevices[i].record.state == internal::ConnectedDevice::State::CONNECTED) {
+            devices[count++] = connectedDevices[i].id;
+        }
     }
-    connectedDevices.clear();
+    return sendToGroup(devices, count, buffer, size);
+}
+
+void UDPTunnel::setGroupAddress(const IPAddress& ip, const uint16_t port) {
+    groupIP   = ip;
+    groupPort = port;
 }
 
-void UDPTunnel::sendMessage(const DeviceID to, uint8_t* buffer, const uint8_t size) {
+SendResult UDPTunnel::admit(const DeviceID to, const MessageSize size) {
     if (isConnected(to) == false) {
         triggerError(to, DEVICE_NOT_CONNECTED, "Device not connected");
+        return SEND_FAILED;
+    }
+    if (size > BPA_MAX_MESSAGE_SIZE) {
+        triggerError(to, MESSAGE_TOO_LARGE, "Message too large");
+        return SEND_FAILED;
+    }
+
+    const auto device = connectedDevices.find(to);
+    const size_t frames = size <= UINT8_MAX ? 1 : fragmentCount(size);
+    const auto queued   = BPA_UDP_QUEUE_SLOTS - freeQueueSlots();
+    // Queued frames take their window slot and their retransmit buffer once they are sent
+    if (device->sent.available() < frames + device->queued ||
+        (reliable && freeRetransmitBuffers() < frames + queued)) {
+        DEBUG_PRINTF("UDPTunnel::admit() - Send window of device %d full\n\r", to);
+        triggerError(to, SEND_WINDOW_FULL, "Send window full");
+        return SEND_WOULD_BLOCK;
+    }
+    if (mayQueue(*device, frames) && freeQueueSlots() < frames) {
+        DEBUG_PRINTF("UDPTunnel::admit() - Send queue full, message to %d rejected\n\r", to);
+        triggerError(to, SEND_WINDOW_FULL, "Send queue full");
+        return SEND_WOULD_BLOCK;
+    }
+    return SEND_OK;
+}
+
+void UDPTunnel::submitMessage(internal::ConnectedDevice& device, internal::OutgoingMessage& message) {
+    if (message.size <= UINT8_MAX) {
+        const auto size = static_cast<uint8_t>(message.size);
+        const auto compressible = (device.capabilities & internal::CAPABILITY_COMPRESSION) && size > LZ_MIN_MATCH;
+        if (compressible && !message.packed) {
+            // Incompressible payloads are sent raw
+            message.packed         = true;
+            message.compressedSize = static_cast<uint8_t>(lzCompress(message.data, size, message.compressed, size - 1));
+        }
+
+        if (compressible && message.compressedSize > 0) {
+            DEBUG_PRINTF("UDPTunnel::submitMessage() - Sending compressed message (%d -> %d bytes)\n\r", size,
+                         message.compressedSize);
+            submit(device, COMPRESSED_V1, message.compressed, message.compressedSize);
+        }
+        else {
+            DEBUG_PRINTF("UDPTunnel::submitMessage() - Sending message of %d bytes\n\r", size);
+            submit(device, START_V1, message.data, size);
+        }
         return;
     }
 
-    DEBUG_PRINTF("UDPTunnel::sendMessage() - Sending message to %d\n\r", to);
-    const auto info       = connectedDevices[to];
-    const auto message_id = doSend(info->getIP(), info->getPort(), START_V1, buffer, size);
-    addPendingPackets(to, message_id);
+    Fragmenter fragmenter(message.transfer, message.data, message.size);
+    DEBUG_PRINTF("UDPTunnel::submitMessage() - Sending message in %d fragments\n\r", fragmenter.fragments());
+    while (fragmenter.next()) {
+        submit(device, FRAGMENT_V1, fragmenter.payload(), fragmenter.payloadSize());
+    }
+}
+
+void UDPTunnel::sendGroup(const uint8_t* members, const size_t count, const uint8_t* data, const uint8_t size) {
+    uint8_t payload[UINT8_MAX];
+    payload[0] = static_cast<uint8_t>(count);
+    memcpy(payload + 1, members, count * 3);
+    memcpy(payload + 1 + count * 3, data, size);
+
+    const auto length = static_cast<uint8_t>(1 + count * 3 + size);
+    DEBUG_PRINTF("UDPTunnel::sendGroup() - Sending message to %d device(s) of the group\n\r", count);
+    doSend(groupIP, groupPort, GROUP_V1, payload, length);
 }
 
 void UDPTunnel::loop() {
-    const auto result = _readMessage();
-    checkForLostPackets();
-    updateConnectedDevicesState();
-    clearStaleHandshakes();
-    if (isMessageEmpty(result) == false) {
-        DEBUG_PRINTLN("UDPTunnel::loop() - Message received");
-        triggerMessageReceived(result.device_id, result.data, result.size);
-    }
-}
-
-BinaryMessage UDPTunnel::_readMessage() {
-    if (udp.parsePacket()) {
-        if (const auto [binaryMessage, validationStatus] = io.read(); validationStatus == STATUS_OK) {
-            DEBUG_PRINTLN("UDPTunnel::_readMessage() - Received packet");
-            if (processReceivedMessage(binaryMessage)) {
-                return binaryMessage;
+    loop(BPA_UDP_LOOP_PACKET_BUDGET, BPA_UDP_LOOP_TIME_BUDGET);
+}
+
+LoopResult UDPTunnel::loop(const size_t packetBudget, const TimeStamp timeBudget) {
+    const auto start  = GET_CURRENT_TIMESTAMP();
+    LoopResult result = {0, false};
+
+    int packetSize;
+    while ((packetSize = nextPacket()) > 0) {
+        if (result.packets > 0 && (result.packets >= packetBudget || GET_CURRENT_TIMESTAMP() - start >= timeBudget)) {
+            // Parsed already, read by the next call
+            parsedPacket       = packetSize;
+            result.morePending = true;
+            break;
+        }
+        _readPacket(packetSize);
+        result.packets++;
+    }
+
+    processTimers();
+    clearStaleFragments();
+    flush();
+    return result;
+}
+
+TimeStamp UDPTunnel::nextExpiry() {
+    const auto now = GET_CURRENT_TIMESTAMP();
+    auto next      = timers.nextExpiry(now + BPA_PING_FREQUENCY);
+    for (auto& [id, device]: connectedDevices) {
+        if (device.queued > 0) {
+            const auto cost = frameLength<BPA_UDP_CHECKSUM>(queue[device.queueHead].size);
+            const auto wait = std::max(device.pacing.waitFor(cost, now), pacing.waitFor(cost, now));
+            next            = static_cast<long>(now + wait - next) < 0 ? now + wait : next;
+        }
+    }
+    return next;
+}
+
+void UDPTunnel::setRateLimit(const uint32_t bytesPerSecond, const uint32_t burst) {
+    pacing.configure(bytesPerSecond, burst, GET_CURRENT_TIMESTAMP());
+}
+
+void UDPTunnel::setDeviceRateLimit(const uint32_t bytesPerSecond, const uint32_t burst) {
+    deviceRate  = bytesPerSecond;
+    deviceBurst = burst;
+    for (auto& [id, device]: connectedDevices) {
+        device.pacing.configure(bytesPerSecond, burst, GET_CURRENT_TIMESTAMP());
+    }
+}
+
+int UDPTunnel::nextPacket() {
+    if (parsedPacket > 0) {
+        return std::exchange(parsedPacket, 0);
+    }
+    return udp.parsePacket();
+}
+
+void UDPTunnel::_readPacket(const int packetSize) {
+    const auto length = udp.read(incoming, std::min(static_cast<size_t>(packetSize), sizeof(incoming)));
+    if (length <= 0) {
+        return;
+    }
+
+    FrameBatchReader<BPA_UDP_CHECKSUM> reader(incoming, length);
+    while (reader.next()) {
+        const auto& message = reader.message();
+        if (reader.status() == STATUS_OK) {
+            DEBUG_PRINTLN("UDPTunnel::_readPacket() - Received frame");
+            if (processReceivedMessage(message)) {
+                DEBUG_PRINTLN("UDPTunnel::_readPacket() - Message received");
+                deliverMessage(message.device_id, message.data, message.size);
             }
         }
         else {
 #if defined(BPA_DEBUG_ENABLED)
-            DEBUG_PRINTF("UDPTunnel::_readMessage() - Invalid message (status: %s)\n\r", validationStatusToString(validationStatus));
+            DEBUG_PRINTF("UDPTunnel::_readPacket() - Invalid message (status: %s)\n\r",
+                         validationStatusToString(reader.status()));
 #endif
-            processInvalidMessage(validationStatus, binaryMessage);
+            processInvalidMessage(reader.status());
         }
     }
-    return emptyMessage();
 }
 
 bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
     const auto deviceId = message.device_id;
-    const auto isKnown  = isKnownDevice(deviceId);
+    const auto device   = connectedDevices.find(deviceId);
+    const auto isKnown  = device != nullptr;
 
+    const auto start = basicStartByte(message.start);
+    if (start == GROUP_V1) {
+        // Sent to a whole group, other devices of the group need not know the sender
+        if (isKnown) {
+            processGroup(message);
+        }
+        return false;
+    }
     if ((isVersionStartByte(message.start) || isControlStartByte(message.start)) && !isKnown) {
         doSend(udp.remoteIP(), udp.remotePort(), DISCONNECT);
         DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Device %d not connected\n\r", deviceId);
         return false;
     }
 
-    switch (message.start) {
+    switch (start) {
         case START_V1: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received message from %d\n\r", deviceId);
-            const auto message_id = doSend(udp.remoteIP(), udp.remotePort(), CONFIRM);
-            addPendingPackets(deviceId, message_id);
+            const auto fresh = acknowledge(*device, message.message_id);
             connectedDevice_receivedPacket(deviceId);
-            return true;
+            return fresh;
+        }
+        case COMPRESSED_V1: {
+            DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received compressed message from %d\n\r", deviceId);
+            processCompressed(message);
+            break;
+        }
+        case FRAGMENT_V1: {
+            DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received fragment from %d\n\r", deviceId);
+            if (acknowledge(*device, message.message_id)) {
+                processFragment(message);
+            }
+            connectedDevice_receivedPacket(deviceId);
+            break;
         }
         case CONFIRM: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received confirmation from %d\n\r", deviceId);
-            pendingPackets_receivedResponse(message.message_id);
+            device->sent.acknowledge(message.message_id, [this, device](MessageID, const internal::SentFrame& frame) {
+                frameCompleted(*device, frame, true);
+            });
+            connectedDevice_receivedPacket(deviceId);
+            break;
+        }
+        case ACKNOWLEDGE: {
+            DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received acknowledgement from %d\n\r", deviceId);
+            processAcknowledge(*device, message);
             connectedDevice_receivedPacket(deviceId);
             break;
         }
@@ -98,20 +319,18 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
         case INCORRECT_CHECKSUM:
         case REJECTED: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received error from %d\n\r", deviceId);
-            pendingPackets_receivedResponse(message.message_id);
             connectedDevice_error(deviceId);
             triggerError(deviceId, INCORRECT_FORMAT_ERROR, "Incorrect format");
             break;
         }
         case PING: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received ping from %d\n\r", deviceId);
-            const auto message_id = doSend(udp.remoteIP(), udp.remotePort(), CONFIRM);
-            addPendingPackets(deviceId, message_id);
+            acknowledge(*device, message.message_id);
             connectedDevice_receivedPacket(deviceId);
             break;
         }
         case HANDSHAKE_INIT: {
-            if (const auto bpaVersion = message.data[0]; bpaVersion != BPA_VERSION) {
+            if (const auto bpaVersion = message.data[0] & internal::VERSION_MASK; bpaVersion != BPA_VERSION) {
                 DEBUG_PRINTF(
                     "UDPTunnel::processReceivedMessage() - Received handshake init from %d with unsuported version\n\r",
                     deviceId);
@@ -119,14 +338,27 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
                 break;
             }
 
+            if (!isKnown && connectedDevices.full()) {
+                DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - No free slot for device %d\n\r", deviceId);
+                doSend(udp.remoteIP(), udp.remotePort(), REJECTED);
+                break;
+            }
+
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received handshake init from %d\n\r", deviceId);
-            const auto seed          = decodeSeed(getID(), message.data[1] << 8 | message.data[2]);
-            pendingConnections[seed] = {udp.remoteIP(), udp.remotePort(), GET_CURRENT_TIMESTAMP()};
-            handshake(internal::HandshakeByte::HANDSHAKE_RESP, seed);
+            const auto seed          = decodeSeed(deviceId, message.data[1] << 8 | message.data[2]);
+            const uint8_t features = message.data[0] & ~internal::VERSION_MASK;
+            const auto keepalive     = decodeKeepalive(message);
+            if (!addPendingConnection(seed, {udp.remoteIP(), udp.remotePort(), GET_CURRENT_TIMESTAMP(), features, 0,
+                                             keepalive, decodeExtensions(message)})) {
+                DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Too many handshakes, %d rejected\n\r", deviceId);
+                doSend(udp.remoteIP(), udp.remotePort(), REJECTED);
+                break;
+            }
+            handshake(HANDSHAKE_RESP, seed);
             break;
         }
         case HANDSHAKE_RESP: {
-            const auto bpaVersion = message.data[0];
+            const auto bpaVersion = message.data[0] & internal::VERSION_MASK;
             if (bpaVersion != BPA_VERSION) {
                 DEBUG_PRINTF(
                     "UDPTunnel::processReceivedMessage() - Received handshake init from %d with unsuported version\n\r",
@@ -136,7 +368,7 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
             }
 
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received handshake response from %d\n\r", deviceId);
-            const auto seed = decodeSeed(getID(), (message.data[1] << 8) | message.data[2]);
+            const auto seed = decodeSeed(deviceId, (message.data[1] << 8) | message.data[2]);
 
             const auto infoRef = pendingConnections.find(seed);
             if (infoRef == pendingConnections.end()) {
@@ -147,18 +379,18 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
                 break;
             }
 
-            auto [ip, port, timestamp] = infoRef->second;
-            const auto device          = new internal::ConnectedDevice(ip, port);
-            connectedDevices[deviceId] = device;
-            pendingConnections.erase(seed);
-            connectedDevice_receivedPacket(deviceId);
-            triggerDeviceConnected(deviceId, *device);
-            doSend(ip, port, HANDSHAKE_COMPLETE);
+            infoRef->second.capabilities = message.data[0] & ~internal::VERSION_MASK;
+            infoRef->second.keepalive    = decodeKeepalive(message);
+            infoRef->second.extensions   = decodeExtensions(message);
+            handshake(HANDSHAKE_COMPLETE, seed);
+            handshakeCompleted(deviceId, infoRef->second);
+            timers.remove(infoRef->second.timer);
+            pendingConnections.erase(infoRef);
             break;
         }
         case HANDSHAKE_COMPLETE: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received handshake complete from %d\n\r", deviceId);
-            const auto seed    = decodeSeed(getID(), message.data[1] << 8 | message.data[2]);
+            const auto seed    = decodeSeed(deviceId, message.data[1] << 8 | message.data[2]);
             const auto infoRef = pendingConnections.find(seed);
             if (infoRef == pendingConnections.end()) {
                 DEBUG_PRINTF(
@@ -168,22 +400,14 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
                 break;
             }
 
-            auto [ip, port, timestamp] = infoRef->second;
-            const auto device          = new internal::ConnectedDevice(ip, port);
-            connectedDevices[deviceId] = device;
-            pendingConnections.erase(seed);
-            connectedDevice_receivedPacket(deviceId);
-            triggerDeviceConnected(deviceId, *device);
+            handshakeCompleted(deviceId, infoRef->second);
+            timers.remove(infoRef->second.timer);
+            pendingConnections.erase(infoRef);
             break;
         }
         case DISCONNECT: {
             DEBUG_PRINTF("UDPTunnel::processReceivedMessage() - Received disconnect from %d\n\r", deviceId);
-            if (isKnown) {
-                const auto device = connectedDevices[deviceId];
-                device->state     = internal::ConnectedDevice::State::DISCONNECTED;
-                delete device;
-                connectedDevices.erase(deviceId);
-            }
+            removeDevice(deviceId);
             break;
         }
         default: {
@@ -194,12 +418,100 @@ bool UDPTunnel::processReceivedMessage(const BinaryMessage& message) {
     return false;
 }
 
-void UDPTunnel::processInvalidMessage(const ValidationStatus status, const BinaryMessage& message) {
-    DEBUG_PRINTF("UDPTunnel::processInvalidMessage() - Invalid message (status: %d)\n\r", status);
-    if (message.message_id != 0) {
-        pendingPackets_receivedResponse(message.message_id);
+void UDPTunnel::deliverMessage(const DeviceID from, uint8_t* data, const MessageSize size) {
+    triggerMessageReceived(from, data, size);
+    if (!hasMessageHandleCallback()) {
+        return;
+    }
+
+    auto handle = messages.acquire();
+    if (!handle) {
+        DEBUG_PRINTF("UDPTunnel::deliverMessage() - No free message slot, message from %d dropped\n\r", from);
+        triggerError(from, MESSAGE_DROPPED, "No free message slot");
+        return;
+    }
+    memcpy(handle.storage(), data, size);
+    handle.assign(from, 0, size);
+    triggerMessageReceived(handle);
+}
+
+void UDPTunnel::deliverMessage(MessageHandle& handle) {
+    triggerMessageReceived(handle.device(), handle.data(), handle.size());
+    triggerMessageReceived(handle);
+}
+
+void UDPTunnel::processCompressed(const BinaryMessage& message) {
+    auto& device = *connectedDevices.find(message.device_id);
+    if (device.received.contains(message.message_id)) {
+        // Delivered already, acknowledged again without taking a message slot
+        acknowledge(device, message.message_id);
+        connectedDevice_receivedPacket(message.device_id);
+        return;
+    }
+
+    auto handle = messages.acquire();
+    if (!handle) {
+        // Not confirmed, the sender reports the message as lost
+        DEBUG_PRINTF("UDPTunnel::processCompressed() - No free message slot, message from %d dropped\n\r",
+                     message.device_id);
+        triggerError(message.device_id, MESSAGE_DROPPED, "No free message slot");
+        return;
+    }
+
+    const auto size = lzDecompress(message.data, message.size, handle.storage(), handle.capacity());
+    if (size == 0) {
+        DEBUG_PRINTF("UDPTunnel::processCompressed() - Malformed compressed payload from %d\n\r", message.device_id);
+        doSend(udp.remoteIP(), udp.remotePort(), INCORRECT_FORMAT);
+        return;
+    }
+
+    acknowledge(device, message.message_id);
+    connectedDevice_receivedPacket(message.device_id);
+    handle.assign(message.device_id, 0, static_cast<MessageSize>(size));
+    deliverMessage(handle);
+}
+
+void UDPTunnel::processFragment(const BinaryMessage& message) {
+    switch (reassembly.push(message.device_id, message.data, message.size, GET_CURRENT_TIMESTAMP())) {
+        case REASSEMBLY_COMPLETE:
+            DEBUG_PRINTF("UDPTunnel::processFragment() - Message from %d reassembled (%d bytes)\n\r",
+                         message.device_id, reassembly.size());
+            deliverMessage(reassembly.device(), reassembly.data(), reassembly.size());
+            break;
+        case REASSEMBLY_TOO_LARGE:
+            triggerError(message.device_id, MESSAGE_TOO_LARGE, "Message too large");
+            break;
+        case REASSEMBLY_NO_SLOT:
+            triggerError(message.device_id, MESSAGE_INCOMPLETE, "No free reassembly buffer");
+            break;
+        default:
+            break;
+    }
+}
+
+void UDPTunnel::processGroup(const BinaryMessage& message) {
+    const auto count    = message.data[0];
+    const size_t offset = 1 + count * 3;
+    if (offset >= message.size) {
+        DEBUG_PRINTF("UDPTunnel::processGroup() - Malformed group message from %d\n\r", message.device_id);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (message.data[1 + i * 3] == getID()) {
+            DEBUG_PRINTF("UDPTunnel::processGroup() - Received group message from %d\n\r", message.device_id);
+            const auto sequence = static_cast<MessageID>(message.data[2 + i * 3] << 8 | message.data[3 + i * 3]);
+            if (acknowledge(*connectedDevices.find(message.device_id), sequence)) {
+                deliverMessage(message.device_id, message.data + offset, message.size - offset);
+            }
+            connectedDevice_receivedPacket(message.device_id);
+            return;
+        }
     }
+}
 
+void UDPTunnel::processInvalidMessage(const ValidationStatus status) {
+    DEBUG_PRINTF("UDPTunnel::processInvalidMessage() - Invalid message (status: %d)\n\r", status);
     switch (status) {
         case STATUS_MISSED_START_BYTE:
         case STATUS_MISSED_DEVICE_ID:
@@ -214,82 +526,472 @@ void UDPTunnel::processInvalidMessage(const ValidationStatus status, const Binar
     }
 }
 
+MessageID UDPTunnel::sendTracked(internal::ConnectedDevice& device, const StartByte start, uint8_t* data,
+                                 const uint8_t size) {
+    if (device.sent.available() == 0) {
+        return 0;
+    }
+    if (device.pendingAcks > 0) {
+        // Travels in the same datagram as the frame
+        sendAcknowledge(device);
+    }
+
+    const auto sequence = track(device, start, data, size);
+    charge(&device, size);
+    enqueue(device.ip, device.port, {sequencedStart(device, start), getID(), sequence, size, data});
+    return sequence;
+}
+
+MessageID UDPTunnel::track(internal::ConnectedDevice& device, const StartByte start, uint8_t* data,
+                           const uint8_t size) {
+    if (device.sent.available() == 0) {
+        return 0;
+    }
+
+    uint8_t tag = 0;
+    if (reliable && isVersionStartByte(start)) {
+        for (size_t i = 0; i < BPA_UDP_RETRANSMIT_SLOTS && tag == 0; i++) {
+            if (!retransmits[i].used) {
+                retransmits[i] = {true, start, size, {}};
+                memcpy(retransmits[i].data, data, size);
+                tag = static_cast<uint8_t>(i + 1);
+            }
+        }
+    }
+
+    const auto now      = GET_CURRENT_TIMESTAMP();
+    const auto sequence = device.sent.push(now, tag);
+    timers.expireBy(device.timer, now + retransmitTimeout(device, *device.sent.oldestFrame()) + 1);
+    return sequence;
+}
+
+bool UDPTunnel::canSend(internal::ConnectedDevice& device, const uint8_t size, const TimeStamp now) {
+    const auto cost = frameLength<BPA_UDP_CHECKSUM>(size);
+    return device.sent.available() > 0 && device.sent.outstanding() < device.cwnd && device.pacing.allows(cost, now) &&
+           pacing.allows(cost, now);
+}
+
+bool UDPTunnel::mayQueue(const internal::ConnectedDevice& device, const size_t frames) const {
+    return device.queued > 0 || pacing.limited() || device.pacing.limited() ||
+           device.sent.outstanding() + frames > device.cwnd;
+}
+
+void UDPTunnel::charge(internal::ConnectedDevice* device, const uint8_t size) {
+    const auto now  = GET_CURRENT_TIMESTAMP();
+    const auto cost = frameLength<BPA_UDP_CHECKSUM>(size);
+    if (device != nullptr) {
+        device->pacing.take(cost, now);
+    }
+    pacing.take(cost, now);
+}
+
+void UDPTunnel::growWindow(internal::ConnectedDevice& device) {
+    if (device.cwnd < BPA_UDP_WINDOW_SIZE && ++device.cwndAcked >= device.cwnd) {
+        device.cwnd++;
+        device.cwndAcked = 0;
+    }
+}
+
+void UDPTunnel::shrinkWindow(internal::ConnectedDevice& device, const MessageID sequence) {
+    const auto limit = device.sent.sequenceLimit();
+    if (sequenceDistance(device.recovery, sequence, limit) > limit / 2) {
+        return; // Sent before the last decrease, part of the same congestion
+    }
+
+    device.cwnd      = std::max(device.cwnd / 2, 1);
+    device.cwndAcked = 0;
+    device.recovery  = advanceSequence(device.sent.oldest(), static_cast<MessageID>(device.sent.inFlight()), limit);
+    DEBUG_PRINTF("UDPTunnel::shrinkWindow() - Congestion window %d after loss of frame %d\n\r", device.cwnd,
+                 sequence);
+}
+
+void UDPTunnel::submit(internal::ConnectedDevice& device, const StartByte start, uint8_t* data, const uint8_t size) {
+    const auto now = GET_CURRENT_TIMESTAMP();
+    if (device.queued == 0 && canSend(device, size, now) && sendTracked(device, start, data, size) != 0) {
+        return;
+    }
+
+    uint8_t slot = 0;
+    while (slot < BPA_UDP_QUEUE_SLOTS && queue[slot].used) {
+        slot++;
+    }
+    if (slot == BPA_UDP_QUEUE_SLOTS) {
+        // admit() reserves the slots, see mayQueue()
+        DEBUG_PRINTLN("UDPTunnel::submit() - No free queue slot, frame dropped");
+        triggerError(deviceId(device), SEND_WINDOW_FULL, "Send queue full");
+        return;
+    }
+    queue[slot] = {true, internal::NO_FRAME, start, size, {}};
+    memcpy(queue[slot].data, data, size);
+
+    if (device.queued++ == 0) {
+        device.queueHead = slot;
+    }
+    else {
+        queue[device.queueTail].next = slot;
+    }
+    device.queueTail = slot;
+}
+
+void UDPTunnel::drainQueues() {
+    const auto count = connectedDevices.size();
+    const auto now   = GET_CURRENT_TIMESTAMP();
+    for (size_t i = 0; i < count; i++) {
+        auto& device = connectedDevices[(drainStart + i) % count].record;
+        while (device.queued > 0) {
+            auto& frame = queue[device.queueHead];
+            // A frame leaves the queue only once it holds a slot of the send window
+            if (!canSend(device, frame.size, now) || sendTracked(device, frame.start, frame.data, frame.size) == 0) {
+                break;
+            }
+
+            frame.used       = false;
+            device.queueHead = frame.next;
+            device.queued--;
+        }
+    }
+    drainStart = count == 0 ? 0 : static_cast<uint8_t>((drainStart + 1) % count);
+}
+
+void UDPTunnel::clearQueue(internal::ConnectedDevice& device) {
+    for (; device.queued > 0; device.queued--) {
+        queue[device.queueHead].used = false;
+        device.queueHead             = queue[device.queueHead].next;
+    }
+}
+
+DeviceID UDPTunnel::deviceId(const internal::ConnectedDevice& device) {
+    for (const auto& entry: connectedDevices) {
+        if (&entry.record == &device) {
+            return entry.id;
+        }
+    }
+    return 0;
+}
+
+size_t UDPTunnel::freeQueueSlots() const {
+    size_t count = 0;
+    for (const auto& frame: queue) {
+        count += frame.used ? 0 : 1;
+    }
+    return count;
+}
+
+size_t UDPTunnel::freeRetransmitBuffers() const {
+    size_t count = 0;
+    for (const auto& buffer: retransmits) {
+        count += buffer.used ? 0 : 1;
+    }
+    return count;
+}
+
+TimeStamp UDPTunnel::retransmitTimeout(const internal::ConnectedDevice& device,
+                                       const internal::SentFrame& frame) const {
+    if (frame.tag == 0) {
+        return BPA_LOST_PACKET_TIMEOUT;
+    }
+
+    const auto rto = device.rtt.timeout(BPA_LOST_PACKET_TIMEOUT, BPA_UDP_MIN_RTO, BPA_UDP_MAX_RTO);
+    return std::min(rto << frame.attempts, static_cast<TimeStamp>(BPA_UDP_MAX_RTO));
+}
+
+void UDPTunnel::retransmit(internal::ConnectedDevice& device, internal::SentFrame& frame, const TimeStamp now) {
+    auto& buffer = retransmits[frame.tag - 1];
+    frame.sentAt = now;
+    frame.attempts++;
+
+    DEBUG_PRINTF("UDPTunnel::retransmit() - Resending frame %d to %s (attempt %d)\n\r", device.sent.oldest(),
+                 device.ip.toString().c_str(), frame.attempts);
+    charge(&device, buffer.size);
+    enqueue(device.ip, device.port, {sequencedStart(device, buffer.start), getID(), device.sent.oldest(), buffer.size,
+                                     buffer.size == 0 ? nullptr : buffer.data});
+}
+
+void UDPTunnel::frameCompleted(internal::ConnectedDevice& device, const internal::SentFrame& frame,
+                               const bool acknowledged) {
+    if (acknowledged && frame.attempts == 0) {
+        // Karn's algorithm, the acknowledgement of a retransmitted frame cannot be matched to one transmission. The
+        // sample includes the time the receiver held the acknowledgement back, BPA_UDP_ACK_DELAY at most
+        device.rtt.sample(GET_CURRENT_TIMESTAMP() - frame.sentAt);
+    }
+    if (acknowledged) {
+        growWindow(device);
+    }
+    if (frame.tag != 0) {
+        retransmits[frame.tag - 1].used = false;
+    }
+}
+
+bool UDPTunnel::acknowledge(internal::ConnectedDevice& device, const MessageID sequence) {
+    const auto fresh = device.received.accept(sequence);
+    if (!fresh) {
+        DEBUG_PRINTF("UDPTunnel::acknowledge() - Duplicate frame %d from %s\n\r", sequence,
+                     device.ip.toString().c_str());
+    }
+    if (!(device.capabilities & internal::CAPABILITY_SELECTIVE_ACK)) {
+        sendControl(device, CONFIRM, sequence);
+        return fresh;
+    }
+
+    const auto now = GET_CURRENT_TIMESTAMP();
+    if (device.pendingAcks == 0) {
+        device.ackDeadline = now + BPA_UDP_ACK_DELAY;
+    }
+    if (device.pendingAcks < BPA_UDP_ACK_FRAMES) {
+        // Saturated, one loop() may read more frames from a device than the counter holds
+        device.pendingAcks++;
+    }
+    if (!fresh || device.received.selective() != 0 || device.pendingAcks >= BPA_UDP_ACK_FRAMES) {
+        // A lost frame or a lost acknowledgement is reported right away, the sender is waiting for it
+        device.ackDeadline = now;
+    }
+    timers.expireBy(device.timer, device.ackDeadline);
+    return fresh;
+}
+
+void UDPTunnel::sendAcknowledge(internal::ConnectedDevice& device) {
+    DEBUG_PRINTF("UDPTunnel::sendAcknowledge() - Acknowledging %d frame(s) up to %d\n\r", device.pendingAcks,
+                 device.received.cumulative());
+    device.pendingAcks = 0;
+
+    // The cumulative sequence number takes two bytes with an extended header, trailing zero bytes of the bitmap are
+    // not sent
+    const auto cumulative = device.received.cumulative();
+    uint8_t payload[6];
+    uint8_t size = 0;
+    if (isExtendedStartByte(sequencedStart(device, ACKNOWLEDGE))) {
+        payload[size++] = highByte(cumulative);
+    }
+    payload[size++] = lowByte(cumulative);
+    for (auto selective = device.received.selective(); selective != 0; selective >>= 8) {
+        payload[size++] = static_cast<uint8_t>(selective);
+    }
+    sendControl(device, ACKNOWLEDGE, generateMessageID(), payload, size);
+}
+
+void UDPTunnel::sendControl(internal::ConnectedDevice& device, const StartByte start, const MessageID id,
+                            uint8_t* data, const uint8_t size) {
+    charge(&device, size);
+    enqueue(device.ip, device.port, {sequencedStart(device, start), getID(), id, size, data});
+}
+
+void UDPTunnel::processAcknowledge(internal::ConnectedDevice& device, const BinaryMessage& message) {
+    const uint8_t width = isExtendedStartByte(message.start) ? 2 : 1;
+    if (message.size < width) {
+        DEBUG_PRINTF("UDPTunnel::processAcknowledge() - Truncated acknowledgement from %d\n\r", message.device_id);
+        return;
+    }
+
+    const auto cumulative = static_cast<MessageID>(width == 2 ? message.data[0] << 8 | message.data[1]
+                                                              : message.data[0]);
+    uint32_t selective = 0;
+    for (uint8_t i = width; i < message.size && i < width + 4; i++) {
+        selective |= static_cast<uint32_t>(message.data[i]) << 8 * (i - width);
+    }
+
+    device.sent.acknowledge(cumulative, selective, [this, &device](MessageID, const internal::SentFrame& frame) {
+        frameCompleted(device, frame, true);
+    });
+
+    // Later frames arrived while the oldest one did not, it is most likely lost
+    const auto inFlight = lowBits(static_cast<uint8_t>(device.sent.inFlight()));
+    if ((device.sent.unacknowledged() & inFlight) != inFlight) {
+        shrinkWindow(device, device.sent.oldest());
+    }
+    DEBUG_PRINTF("UDPTunnel::processAcknowledge() - Acknowledgement from %d, %d frame(s) in flight\n\r",
+                 message.device_id, device.sent.inFlight());
+}
+
 MessageID UDPTunnel::doSend(IPAddress ip, const uint16_t port, const StartByte start, uint8_t* data,
                             const uint8_t size) {
     const BinaryMessage message = {start, getID(), generateMessageID(), size, data};
-    udp.beginPacket(std::move(ip), port);
-    io.write(message);
-    udp.endPacket();
+    charge(nullptr, size);
+    enqueue(ip, port, message);
     return message.message_id;
 }
 
-void UDPTunnel::checkForLostPackets() {
-    const auto now = GET_CURRENT_TIMESTAMP();
-    for (auto it = pendingPackets.begin(); it != pendingPackets.end();) {
-        auto [timestamp, device_id] = it->second;
-        if (now - timestamp > BPA_LOST_PACKET_TIMEOUT) {
-            DEBUG_PRINTF("UDPTunnel::checkForLostPackets() - Packet to device %d lost\n\r", packet.device_id);
-            connectedDevice_lostPacket(device_id);
-            it = pendingPackets.erase(it);
+void UDPTunnel::enqueue(const IPAddress& ip, const uint16_t port, const BinaryMessage& message) {
+    internal::OutgoingDatagram* free = nullptr;
+    for (auto& datagram: outgoing) {
+        if (datagram.frames.empty()) {
+            free = free == nullptr ? &datagram : free;
         }
-        else {
-            ++it;
+        else if (datagram.ip == ip && datagram.port == port) {
+            if (!datagram.frames.fits(message)) {
+                sendDatagram(datagram);
+            }
+            datagram.frames.append(message);
+            return;
         }
     }
+
+    if (free == nullptr) {
+        DEBUG_PRINTLN("UDPTunnel::enqueue() - No free datagram, flushing");
+        flush();
+        free = &outgoing[0];
+    }
+    free->ip   = ip;
+    free->port = port;
+    free->frames.append(message);
 }
 
-void UDPTunnel::updateConnectedDevicesState() {
-    const auto now = GET_CURRENT_TIMESTAMP();
-    for (auto it = connectedDevices.begin(); it != connectedDevices.end();) {
-        const auto deviceId = it->first;
-        const auto device   = it->second;
-
-        if (now - device->lastPing > BPA_PING_FREQUENCY) {
-            const auto message_id = doSend(device->getIP(), device->getPort(), PING);
-            addPendingPackets(deviceId, message_id);
-            device->lastPing = now;
-        }
-
-        if constexpr (BPA_DISCONNECT_ON_LOST_N_PACKETS && device->countOfLost > BPA_DISCONNECT_ON_LOST_N_PACKETS) {
-            DEBUG_PRINTF("UDPTunnel::updateConnectedDevicesState() - Too many packets lost for device %d\n\r",
-                         deviceId);
-            device->state = internal::ConnectedDevice::State::LOST;
-            triggerError(deviceId, DEVICE_LOST, "Device lost");
-        }
-        else if (device->state == internal::ConnectedDevice::State::CONNECTED && now - device->lastSeen >
-                 BPA_STALE_TIMEOUT) {
-            DEBUG_PRINTF("UDPTunnel::updateConnectedDevicesState() - Device %d stale\n\r", deviceId);
-            device->state       = internal::ConnectedDevice::State::LOST;
-            device->lastUpdated = now;
-            triggerError(deviceId, DEVICE_LOST, "Device lost");
-        }
-        else if (device->state == internal::ConnectedDevice::State::LOST && now - device->lastSeen >
-                 BPA_DISCONNECTED_TIMEOUT) {
-            DEBUG_PRINTF("UDPTunnel::updateConnectedDevicesState() - Device %d disconnected by timeout\n\r", deviceId);
-            device->lastUpdated = now;
-            doSend(device->getIP(), device->getPort(), DISCONNECT);
-            delete device;
-            it = connectedDevices.erase(it);
+void UDPTunnel::flush() {
+    drainQueues();
+    for (auto& datagram: outgoing) {
+        sendDatagram(datagram);
+    }
+}
+
+void UDPTunnel::sendDatagram(internal::OutgoingDatagram& datagram) {
+    if (datagram.frames.empty()) {
+        return;
+    }
+
+    DEBUG_PRINTF("UDPTunnel::sendDatagram() - Sending %d frame(s) to %s:%d\n\r", datagram.frames.frames(),
+                 datagram.ip.toString().c_str(), datagram.port);
+    udp.beginPacket(datagram.ip, datagram.port);
+    udp.write(datagram.frames.data(), datagram.frames.length());
+    udp.endPacket();
+    datagram.frames.clear();
+}
+
+void UDPTunnel::processTimers() {
+    timers.advance(GET_CURRENT_TIMESTAMP(), [this](uint8_t, const uint8_t kind, const uint8_t key) {
+        if (kind == internal::TIMER_DEVICE) {
+            updateDevice(key);
         }
         else {
-            ++it;
+            expireHandshake(key);
         }
-    }
+    });
 }
 
-void UDPTunnel::clearStaleHandshakes() {
+void UDPTunnel::updateDevice(const DeviceID deviceId) {
     const auto now = GET_CURRENT_TIMESTAMP();
-    for (auto it = pendingConnections.begin(); it != pendingConnections.end();) {
-        auto [ip, port, timestamp] = it->second;
-        if (now - timestamp > BPA_STALE_TIMEOUT) {
-            DEBUG_PRINTF("UDPTunnel::clearStaleHandshakes() - Clearing stale handshake (IP: %s, port: %d)\n\r",
-                         ip.toString().c_str(), port);
-            it = pendingConnections.erase(it);
+    auto device    = connectedDevices.find(deviceId);
+
+    if (device->pendingAcks > 0 && static_cast<long>(now - device->ackDeadline) >= 0) {
+        sendAcknowledge(*device);
+    }
+
+    size_t failed = 0;
+    while (const auto frame = device->sent.oldestFrame()) {
+        if (now - frame->sentAt <= retransmitTimeout(*device, *frame)) {
+            break;
         }
-        else {
-            ++it;
+        shrinkWindow(*device, device->sent.oldest());
+        if (reliable && frame->tag != 0 && frame->attempts < BPA_UDP_MAX_RETRANSMITS) {
+            retransmit(*device, *frame, now);
+            break; // The other frames are checked once this one is acknowledged
+        }
+
+        DEBUG_PRINTF("UDPTunnel::updateDevice() - Packet %d to device %d lost\n\r", device->sent.oldest(), deviceId);
+        failed += frame->tag != 0 ? 1 : 0;
+        frameCompleted(*device, *frame, false);
+        device->sent.dropOldest();
+        connectedDevice_lostPacket(deviceId);
+    }
+
+    for (; failed > 0; failed--) {
+        triggerError(deviceId, DELIVERY_FAILED, "Delivery failed");
+    }
+    // The error callback may have disconnected the device
+    device = connectedDevices.find(deviceId);
+    if (device == nullptr) {
+        return;
+    }
+
+    if (now - device->lastPing > device->keepalive) {
+        // Skipped while the send window is full, the frames in flight show whether the device is alive
+        device->lastPing = now;
+        if (sendTracked(*device, PING) != 0) {
+            // Nothing was lost during the last interval, a loss brings it back to the shortest one
+            device->keepalive = std::min<uint32_t>(device->keepalive * 2, device->keepaliveMax);
         }
     }
+
+    // Losses are put down to congestion until the window cannot shrink anymore
+    if (BPA_DISCONNECT_ON_LOST_N_PACKETS && device->countOfLost > BPA_DISCONNECT_ON_LOST_N_PACKETS &&
+        device->cwnd == 1) {
+        DEBUG_PRINTF("UDPTunnel::updateDevice() - Too many packets lost for device %d\n\r", deviceId);
+        device->state = internal::ConnectedDevice::State::LOST;
+        triggerError(deviceId, DEVICE_LOST, "Device lost");
+    }
+    else if (device->state == internal::ConnectedDevice::State::CONNECTED && now - device->lastSeen >
+             silenceTimeout(*device, BPA_STALE_TIMEOUT)) {
+        DEBUG_PRINTF("UDPTunnel::updateDevice() - Device %d stale\n\r", deviceId);
+        device->state       = internal::ConnectedDevice::State::LOST;
+        device->lastUpdated = now;
+        triggerError(deviceId, DEVICE_LOST, "Device lost");
+    }
+    else if (device->state == internal::ConnectedDevice::State::LOST && now - device->lastSeen >
+             silenceTimeout(*device, BPA_DISCONNECTED_TIMEOUT)) {
+        DEBUG_PRINTF("UDPTunnel::updateDevice() - Device %d disconnected by timeout\n\r", deviceId);
+        doSend(device->ip, device->port, DISCONNECT);
+        removeDevice(deviceId);
+        return;
+    }
+
+    // The error callback may have disconnected the device
+    device = connectedDevices.find(deviceId);
+    if (device != nullptr) {
+        scheduleDevice(*device);
+    }
+}
+
+void UDPTunnel::scheduleDevice(internal::ConnectedDevice& device) {
+    const auto earliest = [](const TimeStamp a, const TimeStamp b) {
+        return static_cast<long>(b - a) < 0 ? b : a;
+    };
+
+    auto deadline = device.lastPing + device.keepalive + 1;
+    if (const auto frame = device.sent.oldestFrame()) {
+        deadline = earliest(deadline, frame->sentAt + retransmitTimeout(device, *frame) + 1);
+    }
+    if (device.pendingAcks > 0) {
+        deadline = earliest(deadline, device.ackDeadline);
+    }
+    if (device.state == internal::ConnectedDevice::State::CONNECTED) {
+        deadline = earliest(deadline, device.lastSeen + silenceTimeout(device, BPA_STALE_TIMEOUT) + 1);
+    }
+    else {
+        deadline = earliest(deadline, device.lastSeen + silenceTimeout(device, BPA_DISCONNECTED_TIMEOUT) + 1);
+    }
+    timers.schedule(device.timer, deadline);
+}
+
+bool UDPTunnel::removeDevice(const DeviceID deviceId) {
+    const auto device = connectedDevices.find(deviceId);
+    if (device == nullptr) {
+        return false;
+    }
+
+    device->sent.clear([this, device](MessageID, const internal::SentFrame& frame) {
+        frameCompleted(*device, frame, false);
+    });
+    clearQueue(*device);
+    timers.remove(device->timer);
+    connectedDevices.erase(deviceId);
+    reassembly.discard(deviceId);
+    return true;
+}
+
+void UDPTunnel::expireHandshake(const uint8_t seed) {
+    const auto infoRef = pendingConnections.find(seed);
+    if (infoRef == pendingConnections.end()) {
+        return;
+    }
+
+    DEBUG_PRINTF("UDPTunnel::expireHandshake() - Clearing stale handshake (IP: %s, port: %d)\n\r",
+                 infoRef->second.ip.toString().c_str(), infoRef->second.port);
+    timers.remove(infoRef->second.timer);
+    pendingConnections.erase(infoRef);
+}
+
+void UDPTunnel::clearStaleFragments() {
+    reassembly.expire(GET_CURRENT_TIMESTAMP(), BPA_REASSEMBLY_TIMEOUT, [this](const DeviceID deviceId) {
+        triggerError(deviceId, MESSAGE_INCOMPLETE, "Incomplete message");
+    });
 }
 
 uint8_t UDPTunnel::generateSeedForHandshake() {
@@ -300,13 +1002,76 @@ uint8_t UDPTunnel::generateSeedForHandshake() {
     return seed;
 }
 
-void UDPTunnel::handshake(internal::HandshakeByte byte, const uint8_t seed) {
-    DEBUG_PRINTF("UDPTunnel::handshake() - Sending handshake (byte: %d, seed: %d)\n\r", byte, seed);
-    auto [ip, port, timestamp] = pendingConnections[seed];
+void UDPTunnel::handshake(const StartByte start, const uint8_t seed) {
+    DEBUG_PRINTF("UDPTunnel::handshake() - Sending handshake (byte: %d, seed: %d)\n\r", start, seed);
+    const auto& info = pendingConnections[seed];
 
     const uint16_t enc = encode(getID(), seed);
-    uint8_t data[3]    = {BPA_VERSION, lowByte(enc), highByte(enc)};
-    doSend(ip, port, static_cast<StartByte>(byte), data, 3);
+    uint8_t data[6]    = {
+        BPA_VERSION | internal::LOCAL_CAPABILITIES, highByte(enc), lowByte(enc), highByte(BPA_UDP_KEEPALIVE_MIN),
+        lowByte(BPA_UDP_KEEPALIVE_MIN), internal::LOCAL_EXTENSIONS
+    };
+    doSend(info.ip, info.port, start, data, sizeof(data));
+}
+
+bool UDPTunnel::addPendingConnection(const uint8_t seed, internal::HandshakeInfo info) {
+    const auto deadline = info.timestamp + BPA_STALE_TIMEOUT + 1;
+    const auto existing = pendingConnections.find(seed);
+    if (existing != pendingConnections.end()) {
+        info.timer = existing->second.timer;
+        timers.schedule(info.timer, deadline);
+    }
+    else {
+        info.timer = timers.add(internal::TIMER_HANDSHAKE, seed, deadline);
+        if (info.timer == timers.NONE) {
+            return false;
+        }
+    }
+
+    pendingConnections[seed] = std::move(info);
+    return true;
+}
+
+void UDPTunnel::handshakeCompleted(const DeviceID deviceId, const internal::HandshakeInfo& info) {
+    const auto now         = GET_CURRENT_TIMESTAMP();
+    const uint8_t features   = info.capabilities & internal::LOCAL_CAPABILITIES;
+    const uint8_t extensions = info.extensions & internal::LOCAL_EXTENSIONS;
+    const auto limit = extensions & internal::EXTENSION_SEQUENCE_16 ? EXTENDED_SEQUENCE_LIMIT : BASIC_SEQUENCE_LIMIT;
+
+    // Neither device is pinged more often than it asked for
+    const uint16_t keepaliveMin = std::max<uint16_t>(BPA_UDP_KEEPALIVE_MIN, info.keepalive);
+    const uint16_t keepaliveMax = std::max<uint16_t>(BPA_UDP_KEEPALIVE_MAX, keepaliveMin);
+
+    // A device connecting again keeps its timer, the timers are sized for all devices and handshakes
+    const auto existing = connectedDevices.find(deviceId);
+    const auto timer    = existing != nullptr ? existing->timer : timers.NONE;
+    if (existing != nullptr) {
+        existing->sent.clear([this, existing](MessageID, const internal::SentFrame& frame) {
+            frameCompleted(*existing, frame, false);
+        });
+        clearQueue(*existing);
+    }
+
+    const internal::ConnectedDevice record = {
+        info.ip, info.port, now, now, now, internal::ConnectedDevice::State::CONNECTED, 0, 0, features, extensions,
+        timer, 0, now, keepaliveMin, keepaliveMin, keepaliveMax, internal::NO_FRAME, internal::NO_FRAME, 0,
+        BPA_UDP_INITIAL_CWND, 0, 1, SendWindow<BPA_UDP_WINDOW_SIZE>(limit), ReceiveWindow(limit), {}, {}
+    };
+    const auto device = connectedDevices.insert(deviceId, record);
+    if (device == nullptr) {
+        DEBUG_PRINTF("UDPTunnel::handshakeCompleted() - No free slot for device %d\n\r", deviceId);
+        doSend(info.ip, info.port, DISCONNECT);
+        triggerError(deviceId, TOO_MANY_DEVICES, "Too many devices");
+        return;
+    }
+    if (device->timer == timers.NONE) {
+        device->timer = timers.add(internal::TIMER_DEVICE, deviceId, now);
+    }
+    device->pacing.configure(deviceRate, deviceBurst, now);
+    scheduleDevice(*device);
+
+    UdpDeviceInfo deviceInfo(info.ip, info.port);
+    triggerDeviceConnected(deviceId, deviceInfo);
 }
 
 void UDPTunnel::connect(DeviceInfo& info) {
@@ -322,32 +1087,30 @@ void UDPTunnel::connect(DeviceInfo& info) {
 void UDPTunnel::connect(IPAddress ip, const uint16_t port) {
     DEBUG_PRINTF("UDPTunnel::connect() - Connecting to %s:%d\n\r", ip.toString().c_str(), port);
 
-    const uint8_t seed       = generateSeedForHandshake();
-    pendingConnections[seed] = {std::move(ip), port, GET_CURRENT_TIMESTAMP()};
+    const uint8_t seed = generateSeedForHandshake();
+    if (!addPendingConnection(seed, {std::move(ip), port, GET_CURRENT_TIMESTAMP(), 0, 0, 0, 0})) {
+        DEBUG_PRINTLN("UDPTunnel::connect() - Too many handshakes in progress");
+        return;
+    }
 
-    handshake(internal::HandshakeByte::HANDSHAKE_INIT, seed);
+    handshake(HANDSHAKE_INIT, seed);
 }
 
 void UDPTunnel::disconnect(const DeviceID deviceId) {
-    if (!isKnownDevice(deviceId)) {
+    const auto device = connectedDevices.find(deviceId);
+    if (device == nullptr) {
         DEBUG_PRINTF("UDPTunnel::disconnect() - Device %d not connected\n\r", deviceId);
         return; // Device is already lost or disconnected
     }
 
-    const auto device = connectedDevices[deviceId];
     DEBUG_PRINTF("UDPTunnel::disconnect() - Disconnecting device %d\n\r", deviceId);
-    device->state = internal::ConnectedDevice::State::DISCONNECTED;
-    doSend(device->getIP(), device->getPort(), DISCONNECT);
-    delete device;
-    connectedDevices.erase(deviceId);
+    doSend(device->ip, device->port, DISCONNECT);
+    removeDevice(deviceId);
 }
 
 bool UDPTunnel::isConnected(const DeviceID deviceId) {
     const auto device = connectedDevices.find(deviceId);
-    if (device != connectedDevices.end()) {
-        return device->second->state == internal::ConnectedDevice::State::CONNECTED;
-    }
-    return false;
+    return device != nullptr && device->state == internal::ConnectedDevice::State::CONNECTED;
 }
 
 MessageID UDPTunnel::generateMessageID() {
@@ -356,23 +1119,24 @@ MessageID UDPTunnel::generateMessageID() {
 }
 
 void UDPTunnel::connectedDevice_lostPacket(const DeviceID id) {
-    if (!isKnownDevice(id)) {
+    const auto device = connectedDevices.find(id);
+    if (device == nullptr) {
         return; // Device is not known
     }
 
-    const auto device = connectedDevices[id];
     DEBUG_PRINTF(
         "UDPTunnel::connectedDevice_lostPacket() - Device %d did not confirm packet (triggered by timeout)\n\r", id);
     device->countOfLost++;
+    device->keepalive   = device->keepaliveMin;
     device->lastUpdated = GET_CURRENT_TIMESTAMP();
 }
 
 void UDPTunnel::connectedDevice_error(const DeviceID id) {
-    if (!isKnownDevice(id)) {
+    const auto device = connectedDevices.find(id);
+    if (device == nullptr) {
         return; // Device is not known
     }
 
-    const auto device = connectedDevices[id];
     DEBUG_PRINTF("UDPTunnel::connectedDevice_error() - Error occurred while communicating with device %d\n\r", id);
     device->lastUpdated = GET_CURRENT_TIMESTAMP();
     device->lastSeen    = GET_CURRENT_TIMESTAMP();
@@ -380,12 +1144,12 @@ void UDPTunnel::connectedDevice_error(const DeviceID id) {
 }
 
 void UDPTunnel::connectedDevice_receivedPacket(const DeviceID id) {
-    if (!isKnownDevice(getID())) {
+    const auto device = connectedDevices.find(id);
+    if (device == nullptr) {
         return; // Device is not known
     }
 
-    const auto device = connectedDevices[id];
-    DEBUG_PRINTF("UDPTunnel::connectedDevice_receivedPacket() - Received packet from device %d\n\r", device_id);
+    DEBUG_PRINTF("UDPTunnel::connectedDevice_receivedPacket() - Received packet from device %d\n\r", id);
     device->countOfLost   = 0;
     device->countOfErrors = 0;
     device->lastUpdated   = GET_CURRENT_TIMESTAMP();
@@ -393,30 +1157,16 @@ void UDPTunnel::connectedDevice_receivedPacket(const DeviceID id) {
     device->lastPing      = GET_CURRENT_TIMESTAMP();
 
     if (device->state == internal::ConnectedDevice::State::LOST) {
-        DEBUG_PRINTF("UDPTunnel::connectedDevice_receivedPacket() - Set device %d state to CONNECTED\n\r", device_id);
+        DEBUG_PRINTF("UDPTunnel::connectedDevice_receivedPacket() - Set device %d state to CONNECTED\n\r", id);
         device->state = internal::ConnectedDevice::State::CONNECTED;
     }
 }
 
-void UDPTunnel::addPendingPackets(const DeviceID deviceId, const MessageID message_id) {
-    pendingPackets[message_id] = {GET_CURRENT_TIMESTAMP(), deviceId};
-}
-
-void UDPTunnel::pendingPackets_receivedResponse(const MessageID message_id) {
-    const auto packet = pendingPackets.find(message_id);
-    if (packet != pendingPackets.end()) {
-        pendingPackets.erase(packet);
-    }
-}
-
 bool UDPTunnel::isKnownDevice(const DeviceID id) {
-    return connectedDevices.find(id) != connectedDevices.end();
+    return connectedDevices.find(id) != nullptr;
 }
 
 bool UDPTunnel::isLostDevice(const DeviceID id) {
     const auto device = connectedDevices.find(id);
-    if (device != connectedDevices.end()) {
-        return device->second->state == internal::ConnectedDevice::State::LOST;
-    }
-    return false;
+    return device != nullptr && device->state == internal::ConnectedDevice::State::LOST;
 }
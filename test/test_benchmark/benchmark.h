@@ -0,0 +1,32 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <unity.h>
+
+/**
+ * @brief Runs the function the given number of times and reports the throughput in bytes per second.
+ *
+ * @param name The name printed in the report.
+ * @param iterations The number of calls.
+ * @param bytesPerIteration The number of bytes processed by one call.
+ * @param function The measured function.
+ * @return The throughput in bytes per second.
+ */
+template<typename TFunction>
+double benchmark(const char* name, const size_t iterations, const size_t bytesPerIteration, TFunction function) {
+    const auto start = micros();
+    for (size_t i = 0; i < iterations; i++) {
+        function();
+    }
+    const auto elapsed = micros() - start;
+
+    const double bytesPerSecond = elapsed == 0 ? 0 : iterations * bytesPerIteration * 1000000.0 / elapsed;
+    char report[128];
+    snprintf(report, sizeof(report), "%-32s %10lu us %14.0f B/s", name, static_cast<unsigned long>(elapsed),
+             bytesPerSecond);
+    TEST_MESSAGE(report);
+    return bytesPerSecond;
+}
+
+#endif //BENCHMARK_H
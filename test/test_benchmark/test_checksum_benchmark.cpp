@@ -0,0 +1,43 @@
+#include "test_checksum_benchmark.h"
+
+#include <unity.h>
+
+#include "BinaryMessage.h"
+#include "benchmark.h"
+
+static constexpr size_t ITERATIONS = 2000;
+
+template<typename TChecksum>
+static void benchmarkChecksum(const char* name) {
+    static uint8_t payload[255];
+    static uint8_t frame[BPA_MAX_PAYLOAD_SIZE + 8];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 1, 1, sizeof(payload), payload};
+    const auto length                = bpa::encodeFrame<TChecksum>(message, frame, sizeof(frame));
+
+    volatile bpa::ValidationStatus status = bpa::STATUS_OK;
+    const auto bytesPerSecond = benchmark(name, ITERATIONS, length, [&] {
+        status = bpa::decodeFrame<TChecksum>(frame, length).second;
+    });
+
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, status);
+    TEST_ASSERT_TRUE(bytesPerSecond > 0);
+}
+
+void benchmark_checksum_fnv1a16() {
+    benchmarkChecksum<bpa::Fnv1aHash16>("decodeFrame<Fnv1aHash16>");
+}
+
+void benchmark_checksum_crc16Ccitt() {
+    benchmarkChecksum<bpa::Crc16Ccitt>("decodeFrame<Crc16Ccitt>");
+}
+
+void benchmark_checksum_crc32() {
+    benchmarkChecksum<bpa::Crc32>("decodeFrame<Crc32>");
+}
+
+void benchmark_checksum_none() {
+    benchmarkChecksum<bpa::NoChecksum>("decodeFrame<NoChecksum>");
+}
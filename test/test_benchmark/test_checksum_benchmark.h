@@ -0,0 +1,9 @@
+#ifndef TEST_CHECKSUM_BENCHMARK_H
+#define TEST_CHECKSUM_BENCHMARK_H
+
+void benchmark_checksum_fnv1a16();
+void benchmark_checksum_crc16Ccitt();
+void benchmark_checksum_crc32();
+void benchmark_checksum_none();
+
+#endif //TEST_CHECKSUM_BENCHMARK_H
@@ -0,0 +1,77 @@
+#include "test_compression_benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "Compression.h"
+#include "benchmark.h"
+
+static constexpr size_t ITERATIONS = 2000;
+
+/**
+ * @brief Reports the compression ratio and the time needed to compress and decompress the payload.
+ */
+static void benchmarkCompression(const char* name, const uint8_t* payload, const size_t size) {
+    static uint8_t compressed[256];
+    static uint8_t decompressed[256];
+
+    size_t compressedSize = 0;
+    char label[48];
+    snprintf(label, sizeof(label), "lzCompress(%s)", name);
+    benchmark(label, ITERATIONS, size, [&] {
+        compressedSize = bpa::lzCompress(payload, size, compressed, size - 1);
+    });
+
+    char report[96];
+    snprintf(report, sizeof(report), "%-32s %3u -> %3u bytes (%5.1f%%)", name, static_cast<unsigned>(size),
+             static_cast<unsigned>(compressedSize == 0 ? size : compressedSize),
+             100.0 * (compressedSize == 0 ? size : compressedSize) / size);
+    TEST_MESSAGE(report);
+    if (compressedSize == 0) {
+        return; // Incompressible, sent raw
+    }
+
+    size_t decompressedSize = 0;
+    snprintf(label, sizeof(label), "lzDecompress(%s)", name);
+    benchmark(label, ITERATIONS, size, [&] {
+        decompressedSize = bpa::lzDecompress(compressed, compressedSize, decompressed, sizeof(decompressed));
+    });
+    TEST_ASSERT_EQUAL(size, decompressedSize);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, decompressed, size);
+}
+
+void benchmark_compression_telemetry() {
+    // 20 samples of a packed sensor record: timestamp, sensor ID, slowly changing readings
+    uint8_t payload[240];
+    for (size_t i = 0; i < 20; i++) {
+        uint8_t* record = payload + i * 12;
+        const uint32_t timestamp = 1000 + i * 50;
+        memcpy(record, &timestamp, 4);
+        record[4]  = 0x07;
+        record[5]  = 0x00;
+        record[6]  = static_cast<uint8_t>(21 + i / 8);
+        record[7]  = 0x80;
+        record[8]  = 40;
+        record[9]  = 0x00;
+        record[10] = 0x00;
+        record[11] = 0x01;
+    }
+    benchmarkCompression("telemetry", payload, sizeof(payload));
+}
+
+void benchmark_compression_text() {
+    const char text[] = "{\"t\":21.5,\"h\":40,\"p\":1013},{\"t\":21.5,\"h\":41,\"p\":1013},{\"t\":21.6,\"h\":41,\"p\":1012},"
+                        "{\"t\":21.6,\"h\":41,\"p\":1012},{\"t\":21.7,\"h\":42,\"p\":1012},{\"t\":21.7,\"h\":42,\"p\":1011}";
+    benchmarkCompression("json", reinterpret_cast<const uint8_t*>(text), sizeof(text) - 1);
+}
+
+void benchmark_compression_noise() {
+    uint8_t payload[240];
+    uint32_t state = 0x12345678;
+    for (auto& byte: payload) {
+        state = state * 1664525 + 1013904223;
+        byte  = static_cast<uint8_t>(state >> 24);
+    }
+    benchmarkCompression("noise", payload, sizeof(payload));
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_COMPRESSION_BENCHMARK_H
+#define TEST_COMPRESSION_BENCHMARK_H
+
+void benchmark_compression_telemetry();
+void benchmark_compression_text();
+void benchmark_compression_noise();
+
+#endif //TEST_COMPRESSION_BENCHMARK_H
@@ -0,0 +1,110 @@
+#include "test_io_benchmark.h"
+
+#include <string.h>
+#include <unity.h>
+
+#include "BinaryMessage.h"
+#include "benchmark.h"
+
+static constexpr size_t ITERATIONS = 100000;
+
+/**
+ * @brief Stream looping the written bytes back to the reader, so only the cost of the IO layer is measured.
+ *
+ * @tparam TBulkRead Whether readBytes() copies the bytes at once, or inherits the byte-by-byte loop of Stream (as
+ *                   WiFiUDP does).
+ */
+template<bool TBulkRead>
+class LoopbackStream final : public Stream {
+public:
+    size_t write(uint8_t byte) override { return write(&byte, 1); }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (readIndex == writeIndex) {
+            readIndex  = 0;
+            writeIndex = 0;
+        }
+        if (size > sizeof(data) - writeIndex) {
+            size = sizeof(data) - writeIndex;
+        }
+        memcpy(data + writeIndex, buffer, size);
+        writeIndex += size;
+        return size;
+    }
+
+    int available() override { return static_cast<int>(writeIndex - readIndex); }
+
+    int read() override { return readIndex < writeIndex ? data[readIndex++] : -1; }
+
+    int peek() override { return readIndex < writeIndex ? data[readIndex] : -1; }
+
+    size_t readBytes(char* buffer, size_t length) override {
+        if constexpr (!TBulkRead) {
+            return Stream::readBytes(buffer, length);
+        }
+        if (length > writeIndex - readIndex) {
+            length = writeIndex - readIndex;
+        }
+        memcpy(buffer, data + readIndex, length);
+        readIndex += length;
+        return length;
+    }
+
+private:
+    uint8_t data[512] = {};
+    size_t readIndex  = 0;
+    size_t writeIndex = 0;
+};
+
+/**
+ * @brief Writes a small message and reads it back through the given IO.
+ */
+template<typename TIO>
+static void benchmarkIO(const char* name, TIO& io) {
+    uint8_t payload[16];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 1, 1, sizeof(payload), payload};
+
+    volatile bpa::ValidationStatus status = bpa::STATUS_OK;
+    const auto bytesPerSecond = benchmark(name, ITERATIONS, sizeof(payload), [&] {
+        io.write(message);
+        status = io.read().second;
+    });
+
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, status);
+    TEST_ASSERT_TRUE(bytesPerSecond > 0);
+}
+
+template<bool TBulkRead>
+static void benchmarkVirtualStream(const char* name) {
+    LoopbackStream<TBulkRead> stream;
+    // Hides the type of the stream from the optimizer, as when the stream comes from another translation unit
+    Stream* volatile erased = &stream;
+    bpa::BinaryMessageIO io(*erased);
+    benchmarkIO(name, io);
+}
+
+template<bool TBulkRead>
+static void benchmarkConcreteStream(const char* name) {
+    LoopbackStream<TBulkRead> stream;
+    bpa::StreamBinaryMessageIO<LoopbackStream<TBulkRead>> io(stream);
+    benchmarkIO(name, io);
+}
+
+void benchmark_io_virtual_stream() {
+    benchmarkVirtualStream<true>("BinaryMessageIO<Stream>");
+}
+
+void benchmark_io_concrete_stream() {
+    benchmarkConcreteStream<true>("BinaryMessageIO<LoopbackStream>");
+}
+
+void benchmark_io_virtual_byte_stream() {
+    benchmarkVirtualStream<false>("BinaryMessageIO<Stream> bytes");
+}
+
+void benchmark_io_concrete_byte_stream() {
+    benchmarkConcreteStream<false>("BinaryMessageIO<Loopback> bytes");
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_IO_BENCHMARK_H
+#define TEST_IO_BENCHMARK_H
+
+void benchmark_io_virtual_stream();
+void benchmark_io_concrete_stream();
+void benchmark_io_virtual_byte_stream();
+void benchmark_io_concrete_byte_stream();
+
+#endif //TEST_IO_BENCHMARK_H
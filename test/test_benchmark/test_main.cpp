@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "test_checksum_benchmark.h"
+#include "test_compression_benchmark.h"
+#include "test_io_benchmark.h"
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(2000); // service delay
+    UNITY_BEGIN();
+
+    RUN_TEST(benchmark_checksum_fnv1a16);
+    RUN_TEST(benchmark_checksum_crc16Ccitt);
+    RUN_TEST(benchmark_checksum_crc32);
+    RUN_TEST(benchmark_checksum_none);
+    RUN_TEST(benchmark_compression_telemetry);
+    RUN_TEST(benchmark_compression_text);
+    RUN_TEST(benchmark_compression_noise);
+    RUN_TEST(benchmark_io_virtual_stream);
+    RUN_TEST(benchmark_io_concrete_stream);
+    RUN_TEST(benchmark_io_virtual_byte_stream);
+    RUN_TEST(benchmark_io_concrete_byte_stream);
+
+    UNITY_END(); // stop unit testing
+}
+
+void loop()
+{
+}
@@ -0,0 +1,111 @@
+#include "test_checksum.h"
+
+#include <unity.h>
+
+#include "BinaryMessage.h"
+#include "Checksum.h"
+#include "mock_udp.h"
+
+void test_checksum_incrementalMatchesSingleUpdate() {
+    uint8_t bytes[11];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = static_cast<uint8_t>(i * 37 + 5);
+    }
+
+    for (size_t length = 0; length <= sizeof(bytes); length++) {
+        bpa::Fnv1aHash16 expected;
+        for (size_t i = 0; i < length; i++) {
+            expected.update(bytes[i]);
+        }
+
+        for (size_t split = 0; split <= length; split++) {
+            bpa::Fnv1aHash16 hasher;
+            hasher.update(bytes, split);
+            hasher.update(bytes + split, length - split);
+            TEST_ASSERT_EQUAL_HEX16(expected.finalize(), hasher.finalize());
+        }
+    }
+}
+
+void test_checksum_frameIncludesHeader() {
+    uint8_t data[] = {1, 2, 3};
+    const bpa::BinaryMessage message1 = {bpa::StartByte::START_V1, 1, 1, 3, data};
+    const bpa::BinaryMessage message2 = {bpa::StartByte::START_V1, 1, 2, 3, data};
+
+    TEST_ASSERT_EQUAL_HEX16(0xB9A4, bpa::frameChecksum(message1));
+    TEST_ASSERT_NOT_EQUAL(bpa::frameChecksum(message1), bpa::frameChecksum(message2));
+}
+
+void test_checksum_writtenFrameIsReadBack() {
+    uint8_t frame[BPA_MAX_SIZE] = {0};
+    uint8_t data[]              = {9, 8, 7, 6, 5};
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 3, 4, 5, data};
+
+    io.write(message);
+    const auto count = udp.mock_getWroteData(frame, BPA_MAX_SIZE);
+    udp.mock_setPacketToParse(frame, count);
+
+    const auto [received, status] = io.read(udp.parsePacket());
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, status);
+    TEST_ASSERT_EQUAL(5, received.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, received.data, 5);
+}
+
+static const uint8_t CHECK_INPUT[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+void test_checksum_crc16CheckValue() {
+    bpa::Crc16Ccitt crc;
+    crc.update(CHECK_INPUT, sizeof(CHECK_INPUT));
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc.finalize());
+}
+
+void test_checksum_crc32CheckValue() {
+    bpa::Crc32 crc;
+    crc.update(CHECK_INPUT, sizeof(CHECK_INPUT));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc.finalize());
+}
+
+void test_checksum_crc32SlicingMatchesBytewise() {
+    uint8_t bytes[37];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = static_cast<uint8_t>(i * 91 + 17);
+    }
+
+    for (size_t length = 0; length <= sizeof(bytes); length++) {
+        bpa::Crc32 expected;
+        for (size_t i = 0; i < length; i++) {
+            expected.update(bytes[i]);
+        }
+
+        bpa::Crc32 sliced;
+        sliced.update(bytes, length);
+        TEST_ASSERT_EQUAL_HEX32(expected.finalize(), sliced.finalize());
+    }
+}
+
+template<typename TChecksum>
+static void assertRoundTrip() {
+    uint8_t frame[BPA_MAX_PAYLOAD_SIZE + 8] = {0};
+    uint8_t data[]                          = {9, 8, 7, 6, 5};
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 3, 4, 5, data};
+
+    const auto length = bpa::encodeFrame<TChecksum>(message, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(5 + 4 + TChecksum::SIZE, length);
+
+    const auto [received, status] = bpa::decodeFrame<TChecksum>(frame, length);
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, status);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, received.data, 5);
+
+    if (TChecksum::SIZE > 0) {
+        frame[5] ^= 0x01;
+        TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_INCORRECT_CHECKSUM,
+                          bpa::decodeFrame<TChecksum>(frame, length).second);
+    }
+}
+
+void test_checksum_policiesRoundTrip() {
+    assertRoundTrip<bpa::Fnv1aHash16>();
+    assertRoundTrip<bpa::Crc16Ccitt>();
+    assertRoundTrip<bpa::Crc32>();
+    assertRoundTrip<bpa::NoChecksum>();
+}
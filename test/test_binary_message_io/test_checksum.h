@@ -0,0 +1,12 @@
+#ifndef TEST_CHECKSUM_H
+#define TEST_CHECKSUM_H
+
+void test_checksum_incrementalMatchesSingleUpdate();
+void test_checksum_frameIncludesHeader();
+void test_checksum_writtenFrameIsReadBack();
+void test_checksum_crc16CheckValue();
+void test_checksum_crc32CheckValue();
+void test_checksum_crc32SlicingMatchesBytewise();
+void test_checksum_policiesRoundTrip();
+
+#endif //TEST_CHECKSUM_H
@@ -0,0 +1,57 @@
+#include "test_compression.h"
+
+#include <unity.h>
+
+#include "Compression.h"
+
+void test_compression_roundTrip() {
+    const char text[] = "temperature=21.5;humidity=40;temperature=21.6;humidity=41;temperature=21.6;humidity=41;";
+    const auto input  = reinterpret_cast<const uint8_t*>(text);
+    const size_t size = sizeof(text) - 1;
+
+    uint8_t compressed[sizeof(text)];
+    const auto compressedSize = bpa::lzCompress(input, size, compressed, size - 1);
+    TEST_ASSERT_TRUE(compressedSize > 0);
+    TEST_ASSERT_TRUE(compressedSize < size / 2);
+
+    uint8_t output[sizeof(text)];
+    TEST_ASSERT_EQUAL(size, bpa::lzDecompress(compressed, compressedSize, output, sizeof(output)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(input, output, size);
+}
+
+void test_compression_longRun() {
+    uint8_t input[255] = {};
+    input[0] = 0xAA;
+
+    uint8_t compressed[16];
+    const auto compressedSize = bpa::lzCompress(input, sizeof(input), compressed, sizeof(compressed));
+    TEST_ASSERT_TRUE(compressedSize > 0);
+
+    // A back-reference overlapping its own output reproduces the run
+    uint8_t output[sizeof(input)];
+    TEST_ASSERT_EQUAL(sizeof(input), bpa::lzDecompress(compressed, compressedSize, output, sizeof(output)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(input, output, sizeof(input));
+
+    uint8_t tooSmall[100];
+    TEST_ASSERT_EQUAL(0, bpa::lzDecompress(compressed, compressedSize, tooSmall, sizeof(tooSmall)));
+}
+
+void test_compression_incompressible() {
+    uint8_t input[64];
+    for (size_t i = 0; i < sizeof(input); i++) {
+        input[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    uint8_t compressed[sizeof(input)];
+    TEST_ASSERT_EQUAL(0, bpa::lzCompress(input, sizeof(input), compressed, sizeof(input) - 1));
+}
+
+void test_compression_malformedInput() {
+    uint8_t output[32];
+
+    const uint8_t referenceBeforeData[] = {0x01, 0x00, 0x00};
+    TEST_ASSERT_EQUAL(0, bpa::lzDecompress(referenceBeforeData, sizeof(referenceBeforeData), output, sizeof(output)));
+
+    const uint8_t truncatedReference[] = {0x02, 'a', 0x00};
+    TEST_ASSERT_EQUAL(0, bpa::lzDecompress(truncatedReference, sizeof(truncatedReference), output, sizeof(output)));
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_COMPRESSION_H
+#define TEST_COMPRESSION_H
+
+void test_compression_roundTrip();
+void test_compression_longRun();
+void test_compression_incompressible();
+void test_compression_malformedInput();
+
+#endif //TEST_COMPRESSION_H
@@ -0,0 +1,102 @@
+#include "test_fragmentation.h"
+
+#include <unity.h>
+
+#include "BinaryMessage.h"
+#include "Fragmentation.h"
+
+namespace {
+    constexpr size_t MESSAGE_SIZE = 600;
+
+    void fillMessage(uint8_t* message, const size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            message[i] = static_cast<uint8_t>(i * 7);
+        }
+    }
+}
+
+void test_validateMessage_fragment_headerRequired() {
+    uint8_t data[] = {1, 0, 2, 42};
+    const bpa::BinaryMessage headerOnly = {bpa::StartByte::FRAGMENT_V1, 1, 1, 3, data};
+    const bpa::BinaryMessage fragment = {bpa::StartByte::FRAGMENT_V1, 1, 2, 4, data};
+
+    TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::validateMessage(headerOnly));
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::validateMessage(fragment));
+}
+
+void test_fragmenter_splitsMessage() {
+    uint8_t message[MESSAGE_SIZE];
+    fillMessage(message, MESSAGE_SIZE);
+
+    bpa::Fragmenter fragmenter(9, message, MESSAGE_SIZE);
+    TEST_ASSERT_EQUAL(3, fragmenter.fragments());
+
+    const uint8_t expectedSizes[] = {255, 255, 3 + 96};
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(fragmenter.next());
+        TEST_ASSERT_EQUAL(expectedSizes[i], fragmenter.payloadSize());
+        TEST_ASSERT_EQUAL(9, fragmenter.payload()[0]);
+        TEST_ASSERT_EQUAL(i, fragmenter.payload()[1]);
+        TEST_ASSERT_EQUAL(3, fragmenter.payload()[2]);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(message + i * bpa::internal::FRAGMENT_CHUNK_SIZE, fragmenter.payload() + 3,
+                                      fragmenter.payloadSize() - 3);
+    }
+    TEST_ASSERT_FALSE(fragmenter.next());
+}
+
+void test_reassembly_outOfOrderAndDuplicates() {
+    uint8_t message[MESSAGE_SIZE];
+    fillMessage(message, MESSAGE_SIZE);
+
+    uint8_t payloads[3][255];
+    uint8_t sizes[3];
+    bpa::Fragmenter fragmenter(1, message, MESSAGE_SIZE);
+    for (auto i = 0; fragmenter.next(); i++) {
+        memcpy(payloads[i], fragmenter.payload(), fragmenter.payloadSize());
+        sizes[i] = fragmenter.payloadSize();
+    }
+
+    bpa::ReassemblyPool<2, 1024> pool;
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_PENDING, pool.push(5, payloads[2], sizes[2], 0));
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_PENDING, pool.push(5, payloads[0], sizes[0], 0));
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_DUPLICATE, pool.push(5, payloads[0], sizes[0], 0));
+    TEST_ASSERT_EQUAL(1, pool.pending());
+
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_COMPLETE, pool.push(5, payloads[1], sizes[1], 0));
+    TEST_ASSERT_EQUAL(5, pool.device());
+    TEST_ASSERT_EQUAL(MESSAGE_SIZE, pool.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(message, pool.data(), MESSAGE_SIZE);
+    TEST_ASSERT_EQUAL(0, pool.pending());
+}
+
+void test_reassembly_tooLarge() {
+    uint8_t message[MESSAGE_SIZE];
+    fillMessage(message, MESSAGE_SIZE);
+
+    bpa::ReassemblyPool<1, 300> pool;
+    bpa::Fragmenter fragmenter(1, message, MESSAGE_SIZE);
+    TEST_ASSERT_TRUE(fragmenter.next());
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_TOO_LARGE,
+                      pool.push(5, fragmenter.payload(), fragmenter.payloadSize(), 0));
+    TEST_ASSERT_EQUAL(0, pool.pending());
+
+    uint8_t shortFragment[] = {2, 0, 2, 42};
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_INVALID, pool.push(5, shortFragment, sizeof(shortFragment), 0));
+}
+
+void test_reassembly_expire() {
+    uint8_t first[255] = {1, 0, 2};
+    uint8_t second[255] = {2, 0, 2};
+
+    bpa::ReassemblyPool<1, 1024> pool;
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_PENDING, pool.push(5, first, sizeof(first), 100));
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_NO_SLOT, pool.push(6, second, sizeof(second), 100));
+
+    bpa::DeviceID expiredDevice = 0;
+    const auto onExpired = [&expiredDevice](const bpa::DeviceID device) { expiredDevice = device; };
+    TEST_ASSERT_EQUAL(0, pool.expire(1000, 1000, onExpired));
+    TEST_ASSERT_EQUAL(1, pool.expire(1101, 1000, onExpired));
+    TEST_ASSERT_EQUAL(5, expiredDevice);
+
+    TEST_ASSERT_EQUAL(bpa::REASSEMBLY_PENDING, pool.push(6, second, sizeof(second), 1200));
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_FRAGMENTATION_H
+#define TEST_FRAGMENTATION_H
+
+void test_validateMessage_fragment_headerRequired();
+void test_fragmenter_splitsMessage();
+void test_reassembly_outOfOrderAndDuplicates();
+void test_reassembly_tooLarge();
+void test_reassembly_expire();
+
+#endif //TEST_FRAGMENTATION_H
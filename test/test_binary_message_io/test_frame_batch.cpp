@@ -0,0 +1,109 @@
+#include "test_frame_batch.h"
+
+#include <unity.h>
+
+#include "FrameBatch.h"
+
+void test_frameBatch_appendAndRead() {
+    bpa::FrameBatch<64> batch;
+    uint8_t data[] = {1, 2, 3};
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::START_V1, 1, 1, 3, data}));
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::CONFIRM, 1, 2, 0, nullptr}));
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::PING, 1, 3, 0, nullptr}));
+    TEST_ASSERT_EQUAL(3, batch.frames());
+    TEST_ASSERT_EQUAL(9 + 6 + 6, batch.length());
+
+    uint8_t packet[64];
+    memcpy(packet, batch.data(), batch.length());
+    bpa::FrameBatchReader<> reader(packet, batch.length());
+
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, reader.status());
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, reader.message().start);
+    TEST_ASSERT_EQUAL(3, reader.message().data[2]);
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, reader.message().start);
+    TEST_ASSERT_EQUAL(2, reader.message().message_id);
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, reader.message().start);
+    TEST_ASSERT_FALSE(reader.next());
+
+    batch.clear();
+    TEST_ASSERT_TRUE(batch.empty());
+    TEST_ASSERT_EQUAL(0, batch.length());
+}
+
+void test_frameBatch_capacity() {
+    bpa::FrameBatch<15> batch;
+    uint8_t data[] = {1, 2, 3};
+    TEST_ASSERT_TRUE(batch.fits(3));
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::START_V1, 1, 1, 3, data}));
+    TEST_ASSERT_TRUE(batch.fits(0));
+    TEST_ASSERT_FALSE(batch.fits(1));
+    TEST_ASSERT_FALSE(batch.append({bpa::StartByte::START_V1, 1, 2, 3, data}));
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::PING, 1, 3, 0, nullptr}));
+    TEST_ASSERT_EQUAL(2, batch.frames());
+}
+
+void test_frameBatch_extendedHeader() {
+    bpa::FrameBatch<64> batch;
+    uint8_t data[] = {1, 2, 3};
+    const auto start = bpa::extendedStartByte(bpa::StartByte::START_V1);
+    TEST_ASSERT_TRUE(batch.fits({start, 1, 0x1234, 3, data}));
+    TEST_ASSERT_TRUE(batch.append({start, 1, 0x1234, 3, data}));
+    TEST_ASSERT_TRUE(batch.append({bpa::StartByte::PING, 1, 0x56, 0, nullptr}));
+    TEST_ASSERT_EQUAL(10 + 6, batch.length());
+
+    uint8_t packet[64];
+    memcpy(packet, batch.data(), batch.length());
+    TEST_ASSERT_EQUAL(0x34, packet[2]); // The low byte stays at the place of the basic message ID
+    TEST_ASSERT_EQUAL(0x12, packet[4]);
+    bpa::FrameBatchReader<> reader(packet, batch.length());
+
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, reader.status());
+    TEST_ASSERT_EQUAL(start, reader.message().start);
+    TEST_ASSERT_EQUAL(0x1234, reader.message().message_id);
+    TEST_ASSERT_EQUAL(3, reader.message().size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, reader.message().data, 3);
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, reader.message().start);
+    TEST_ASSERT_EQUAL(0x56, reader.message().message_id);
+    TEST_ASSERT_FALSE(reader.next());
+
+    // The high byte is covered by the checksum
+    packet[4] ^= 0x01;
+    bpa::FrameBatchReader<> corrupted(packet, batch.length());
+    TEST_ASSERT_TRUE(corrupted.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_CHECKSUM, corrupted.status());
+}
+
+void test_frameBatchReader_skipsInvalidFrame() {
+    uint8_t packet[] = {
+        0x41, 0x01, 0x01, 0x00, 0x01, 0x01, // CONFIRM with a broken checksum
+        0x50, 0x01, 0x02, 0x00, 0xE1, 0xE4  // PING
+    };
+    bpa::FrameBatchReader<> reader(packet, sizeof(packet));
+
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_CHECKSUM, reader.status());
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, reader.status());
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, reader.message().start);
+    TEST_ASSERT_FALSE(reader.next());
+}
+
+void test_frameBatchReader_truncatedFrame() {
+    uint8_t packet[] = {
+        0x41, 0x01, 0x01, 0x00, 0xF0, 0x76, // CONFIRM
+        0x30, 0x01, 0x01, 0x03, 0x01        // Truncated START_V1
+    };
+    bpa::FrameBatchReader<> reader(packet, sizeof(packet));
+
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, reader.status());
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL(bpa::STATUS_UNEXPECTED_END_OF_STREAM, reader.status());
+    TEST_ASSERT_TRUE(bpa::isMessageEmpty(reader.message()));
+    TEST_ASSERT_FALSE(reader.next());
+}
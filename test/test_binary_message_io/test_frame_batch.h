@@ -0,0 +1,10 @@
+#ifndef TEST_FRAME_BATCH_H
+#define TEST_FRAME_BATCH_H
+
+void test_frameBatch_appendAndRead();
+void test_frameBatch_capacity();
+void test_frameBatch_extendedHeader();
+void test_frameBatchReader_skipsInvalidFrame();
+void test_frameBatchReader_truncatedFrame();
+
+#endif //TEST_FRAME_BATCH_H
@@ -6,6 +6,14 @@
 #include "test_message_validation.h"
 #include "test_message_write.h"
 #include "test_message_read.h"
+#include "test_message_parser.h"
+#include "test_checksum.h"
+#include "test_frame_batch.h"
+#include "test_fragmentation.h"
+#include "test_compression.h"
+#include "test_serializer.h"
+#include "test_ring_buffer.h"
+#include "test_message_pool.h"
 
 MockUDP udp;
 
@@ -38,7 +46,7 @@ void setup()
     RUN_TEST(test_validateMessage_invalidDeviceID);
     RUN_TEST(test_validateMessage_invalidMessageID);
     RUN_TEST(test_validateMessage_invalidSize);
-    RUN_TEST(test_validateMessage_handshake_sizeShouldBe3);
+    RUN_TEST(test_validateMessage_handshake_sizeShouldBe3_5Or6);
     RUN_TEST(test_validateMessage_ping_payloadShouldBeEmpty);
     RUN_TEST(test_validateMessage_confirm_payloadShouldBeEmpty);
     RUN_TEST(test_validateMessage_rejected_payloadShouldBeEmpty);
@@ -48,10 +56,59 @@ void setup()
     RUN_TEST(test_writeMessage_withData);
     RUN_TEST(test_writeMessage_withoutData);
     RUN_TEST(test_writeMessage_checksumShouldBeCalculated);
+    RUN_TEST(test_writeMessage_singleStreamWrite);
+    RUN_TEST(test_encodeFrame_toBuffer);
+    RUN_TEST(test_encodeFrame_notEnoughCapacity);
+    RUN_TEST(test_checksum_incrementalMatchesSingleUpdate);
+    RUN_TEST(test_checksum_frameIncludesHeader);
+    RUN_TEST(test_checksum_writtenFrameIsReadBack);
+    RUN_TEST(test_checksum_crc16CheckValue);
+    RUN_TEST(test_checksum_crc32CheckValue);
+    RUN_TEST(test_checksum_crc32SlicingMatchesBytewise);
+    RUN_TEST(test_checksum_policiesRoundTrip);
     RUN_TEST(test_readMessage_withoutData);
     RUN_TEST(test_readMessage_withData);
     RUN_TEST(test_readMessage_incorrectStreamLength);
     RUN_TEST(test_readMessage_invalidChecksum);
+    RUN_TEST(test_readMessage_stopsAtEndOfFrame);
+    RUN_TEST(test_readMessage_withPacketLength);
+    RUN_TEST(test_readMessage_withPacketLength_sizeMismatch);
+    RUN_TEST(test_readMessage_withPacketLength_tooShort);
+    RUN_TEST(test_parser_byteByByte);
+    RUN_TEST(test_parser_extendedHeader);
+    RUN_TEST(test_parser_skipsNoiseBeforeStartByte);
+    RUN_TEST(test_parser_resyncAfterInvalidChecksum);
+    RUN_TEST(test_parser_resyncInsideRejectedFrame);
+    RUN_TEST(test_parser_pollFromStream);
+    RUN_TEST(test_frameBatch_appendAndRead);
+    RUN_TEST(test_frameBatch_capacity);
+    RUN_TEST(test_frameBatch_extendedHeader);
+    RUN_TEST(test_frameBatchReader_skipsInvalidFrame);
+    RUN_TEST(test_frameBatchReader_truncatedFrame);
+    RUN_TEST(test_validateMessage_fragment_headerRequired);
+    RUN_TEST(test_fragmenter_splitsMessage);
+    RUN_TEST(test_reassembly_outOfOrderAndDuplicates);
+    RUN_TEST(test_reassembly_tooLarge);
+    RUN_TEST(test_reassembly_expire);
+    RUN_TEST(test_compression_roundTrip);
+    RUN_TEST(test_compression_longRun);
+    RUN_TEST(test_compression_incompressible);
+    RUN_TEST(test_compression_malformedInput);
+    RUN_TEST(test_serializer_fixedLayout);
+    RUN_TEST(test_serializer_varintLayout);
+    RUN_TEST(test_serializer_varintBoundaries);
+    RUN_TEST(test_serializer_rejectsMalformedPayload);
+    RUN_TEST(test_ringBuffer_pushAndRead);
+    RUN_TEST(test_ringBuffer_overflow);
+    RUN_TEST(test_ringBuffer_wrapAround);
+    RUN_TEST(test_parser_ringFrameInPlace);
+    RUN_TEST(test_parser_ringWrappedFrameIsCopied);
+    RUN_TEST(test_parser_ringResyncAndPartialFrame);
+    RUN_TEST(test_messagePool_acquireAndRelease);
+    RUN_TEST(test_messagePool_withoutSlots);
+    RUN_TEST(test_messagePool_handleIsMoved);
+    RUN_TEST(test_readMessage_intoPoolSlot);
+    RUN_TEST(test_readMessage_intoPoolSlot_invalidFrame);
 
     UNITY_END(); // stop unit testing
 }
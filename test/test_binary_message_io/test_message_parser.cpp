@@ -0,0 +1,113 @@
+#include "test_message_parser.h"
+
+#include <unity.h>
+
+#include "BinaryMessageParser.h"
+#include "mock_udp.h"
+
+static size_t pushAll(bpa::BinaryMessageParser& parser, const uint8_t* data, const size_t size,
+                      bpa::BinaryMessage* messages) {
+    size_t found = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (parser.push(data[i])) {
+            messages[found++] = parser.message();
+        }
+    }
+    return found;
+}
+
+void test_parser_byteByByte() {
+    bpa::BinaryMessageParser parser;
+    const uint8_t data[] = {0x30, 0x01, 0x01, 0x03, 0x01, 0x02, 0x03, 0xB9, 0xA4};
+    for (size_t i = 0; i < sizeof(data) - 1; i++) {
+        TEST_ASSERT_FALSE(parser.push(data[i]));
+    }
+    TEST_ASSERT_TRUE(parser.push(data[sizeof(data) - 1]));
+
+    const auto& message = parser.message();
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, message.start);
+    TEST_ASSERT_EQUAL(1, message.device_id);
+    TEST_ASSERT_EQUAL(1, message.message_id);
+    TEST_ASSERT_EQUAL(3, message.size);
+    TEST_ASSERT_EQUAL(1, message.data[0]);
+    TEST_ASSERT_EQUAL(3, message.data[2]);
+}
+
+void test_parser_extendedHeader() {
+    bpa::BinaryMessageParser parser;
+    bpa::BinaryMessage messages[2];
+    uint8_t payload[] = {7};
+    uint8_t data[16];
+    const auto length = bpa::encodeFrame<>({bpa::extendedStartByte(bpa::StartByte::PING), 1, 0x0102, 0, nullptr},
+                                           data, sizeof(data));
+    TEST_ASSERT_EQUAL(7, length);
+    const auto total = length + bpa::encodeFrame<>({bpa::StartByte::START_V1, 1, 3, 1, payload}, data + length,
+                                                   sizeof(data) - length);
+
+    TEST_ASSERT_EQUAL(2, pushAll(parser, data, total, messages));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, bpa::basicStartByte(messages[0].start));
+    TEST_ASSERT_EQUAL(0x0102, messages[0].message_id);
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, messages[1].start);
+    TEST_ASSERT_EQUAL(3, messages[1].message_id);
+    TEST_ASSERT_EQUAL(0, parser.rejectedFrames());
+}
+
+void test_parser_skipsNoiseBeforeStartByte() {
+    bpa::BinaryMessageParser parser;
+    bpa::BinaryMessage messages[2];
+    const uint8_t data[] = {0x00, 0xFF, 0x13, 0x41, 0x01, 0x01, 0x00, 0xF0, 0x76};
+
+    TEST_ASSERT_EQUAL(1, pushAll(parser, data, sizeof(data), messages));
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, messages[0].start);
+    TEST_ASSERT_EQUAL(3, parser.droppedBytes());
+}
+
+void test_parser_resyncAfterInvalidChecksum() {
+    bpa::BinaryMessageParser parser;
+    bpa::BinaryMessage messages[2];
+    const uint8_t data[] = {
+        0x41, 0x01, 0x01, 0x00, 0x01, 0x01, // CONFIRM with a broken checksum
+        0x50, 0x01, 0x02, 0x00, 0xE1, 0xE4  // PING
+    };
+
+    TEST_ASSERT_EQUAL(1, pushAll(parser, data, sizeof(data), messages));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, messages[0].start);
+    TEST_ASSERT_EQUAL(2, messages[0].message_id);
+    TEST_ASSERT_EQUAL(1, parser.rejectedFrames());
+}
+
+void test_parser_resyncInsideRejectedFrame() {
+    bpa::BinaryMessageParser parser;
+    bpa::BinaryMessage messages[3];
+    const uint8_t data[] = {
+        0x30, 0x01, 0x01, 0x05,                         // START_V1 header with a corrupted size
+        0x41, 0x01, 0x01, 0x00, 0xF0, 0x76,             // CONFIRM
+        0x30, 0x01, 0x03, 0x02, 0xAA, 0xBB, 0x1F, 0x76, // START_V1
+    };
+
+    TEST_ASSERT_EQUAL(2, pushAll(parser, data, sizeof(data), messages));
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, messages[0].start);
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, messages[1].start);
+    TEST_ASSERT_EQUAL(3, messages[1].message_id);
+    TEST_ASSERT_EQUAL(2, messages[1].size);
+}
+
+void test_parser_pollFromStream() {
+    bpa::BinaryMessageParser parser;
+    const uint8_t data[] = {
+        0x41, 0x01, 0x01, 0x00, 0xF0, 0x76, // CONFIRM
+        0x50, 0x01, 0x02, 0x00, 0xE1        // Incomplete PING
+    };
+    udp.mock_setPacketToParse(data, sizeof(data));
+
+    TEST_ASSERT_TRUE(parser.poll(udp));
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, parser.message().start);
+    TEST_ASSERT_EQUAL(5, udp.available());
+
+    TEST_ASSERT_FALSE(parser.poll(udp));
+    TEST_ASSERT_EQUAL(0, udp.available());
+    TEST_ASSERT_TRUE(bpa::isMessageEmpty(parser.message()));
+
+    TEST_ASSERT_TRUE(parser.push(0xE4));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, parser.message().start);
+}
@@ -0,0 +1,11 @@
+#ifndef TEST_MESSAGE_PARSER_H
+#define TEST_MESSAGE_PARSER_H
+
+void test_parser_byteByByte();
+void test_parser_extendedHeader();
+void test_parser_skipsNoiseBeforeStartByte();
+void test_parser_resyncAfterInvalidChecksum();
+void test_parser_resyncInsideRejectedFrame();
+void test_parser_pollFromStream();
+
+#endif //TEST_MESSAGE_PARSER_H
@@ -0,0 +1,88 @@
+#include "test_message_pool.h"
+
+#include <unity.h>
+
+#include "MessagePool.h"
+#include "mock_udp.h"
+
+void test_messagePool_acquireAndRelease() {
+    bpa::MessagePool<2, 16> pool;
+    TEST_ASSERT_EQUAL(2, pool.available());
+    {
+        auto first  = pool.acquire();
+        auto second = pool.acquire();
+        TEST_ASSERT_TRUE(static_cast<bool>(first));
+        TEST_ASSERT_TRUE(static_cast<bool>(second));
+        TEST_ASSERT_TRUE(first.storage() != second.storage());
+        TEST_ASSERT_EQUAL(16, first.capacity());
+        TEST_ASSERT_FALSE(static_cast<bool>(pool.acquire()));
+        TEST_ASSERT_EQUAL(0, pool.available());
+
+        first.reset();
+        TEST_ASSERT_FALSE(static_cast<bool>(first));
+        TEST_ASSERT_EQUAL(1, pool.available());
+    }
+    TEST_ASSERT_EQUAL(2, pool.available());
+}
+
+void test_messagePool_withoutSlots() {
+    bpa::MessagePool<0, 16> pool;
+    TEST_ASSERT_EQUAL(0, pool.available());
+    TEST_ASSERT_FALSE(static_cast<bool>(pool.acquire()));
+}
+
+void test_messagePool_handleIsMoved() {
+    bpa::MessagePool<2, 16> pool;
+    auto handle = pool.acquire();
+    handle.storage()[1] = 0x42;
+    handle.assign(7, 1, 1);
+
+    bpa::MessageHandle queued[2];
+    queued[0] = std::move(handle);
+    TEST_ASSERT_FALSE(static_cast<bool>(handle));
+    TEST_ASSERT_EQUAL(1, pool.available());
+    TEST_ASSERT_EQUAL(7, queued[0].device());
+    TEST_ASSERT_EQUAL(1, queued[0].size());
+    TEST_ASSERT_EQUAL(0x42, queued[0].data()[0]);
+
+    bpa::MessageHandle moved(std::move(queued[0]));
+    TEST_ASSERT_EQUAL(0x42, moved.data()[0]);
+
+    queued[1] = pool.acquire();
+    queued[1] = std::move(moved); // The slot held by queued[1] is released
+    TEST_ASSERT_EQUAL(1, pool.available());
+}
+
+void test_readMessage_intoPoolSlot() {
+    bpa::MessagePool<2, bpa::BinaryMessageIO::MAX_FRAME_SIZE> pool;
+    const uint8_t first[]  = {0x30, 0x01, 0x01, 0x03, 0x01, 0x02, 0x03, 0xB9, 0xA4};
+    const uint8_t second[] = {0x41, 0x01, 0x01, 0x00, 0xF0, 0x76};
+
+    auto handle = pool.acquire();
+    udp.mock_setPacketToParse(first, sizeof(first));
+    const auto [message, status] = io.read(handle);
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, status);
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, message.start);
+    TEST_ASSERT_EQUAL_PTR(handle.data(), message.data);
+    TEST_ASSERT_EQUAL(1, handle.device());
+    TEST_ASSERT_EQUAL(3, handle.size());
+
+    // The next read does not overwrite the message held by the handle
+    udp.mock_setPacketToParse(second, sizeof(second));
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, io.read(sizeof(second)).second);
+    TEST_ASSERT_EQUAL(1, handle.data()[0]);
+    TEST_ASSERT_EQUAL(3, handle.data()[2]);
+}
+
+void test_readMessage_intoPoolSlot_invalidFrame() {
+    bpa::MessagePool<1, bpa::BinaryMessageIO::MAX_FRAME_SIZE> pool;
+    bpa::MessagePool<1, 8> smallPool;
+    const uint8_t data[] = {0x30, 0x01, 0x01, 0x03, 0x01, 0x02, 0x03, 0xB9, 0x00};
+
+    auto handle = pool.acquire();
+    udp.mock_setPacketToParse(data, sizeof(data));
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_INCORRECT_CHECKSUM, io.read(handle, sizeof(data)).second);
+
+    auto small = smallPool.acquire();
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_STREAM_ERROR, io.read(small).second);
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_MESSAGE_POOL_H
+#define TEST_MESSAGE_POOL_H
+
+void test_messagePool_acquireAndRelease();
+void test_messagePool_withoutSlots();
+void test_messagePool_handleIsMoved();
+void test_readMessage_intoPoolSlot();
+void test_readMessage_intoPoolSlot_invalidFrame();
+
+#endif //TEST_MESSAGE_POOL_H
@@ -49,3 +49,39 @@ void test_readMessage_invalidChecksum() {
     TEST_ASSERT_EQUAL(nullptr, message.data);
     TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_INCORRECT_CHECKSUM, status);
 }
+
+void test_readMessage_stopsAtEndOfFrame() {
+    const uint8_t data[] = {0x41, 0x01, 0x01, 0x00, 0xF0, 0x76, 0x41, 0x01};
+    udp.mock_setPacketToParse(data, 8);
+    const auto [message, status] = io.read();
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, message.start);
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, status);
+    TEST_ASSERT_EQUAL(2, udp.available());
+}
+
+void test_readMessage_withPacketLength() {
+    const uint8_t data[] = {0x30, 0x01, 0x01, 0x03, 0x01, 0x02, 0x03, 0xB9, 0xA4};
+    udp.mock_setPacketToParse(data, 9);
+    const auto [message, status] = io.read(udp.parsePacket());
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, message.start);
+    TEST_ASSERT_EQUAL(3, message.size);
+    TEST_ASSERT_EQUAL(3, message.data[2]);
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_OK, status);
+}
+
+void test_readMessage_withPacketLength_sizeMismatch() {
+    const uint8_t data[] = {0x41, 0x01, 0x01, 0x00, 0xF0, 0x76, 0x00};
+    udp.mock_setPacketToParse(data, 7);
+    const auto [message, status] = io.read(udp.parsePacket());
+    TEST_ASSERT_TRUE(bpa::isMessageEmpty(message));
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_UNEXPECTED_END_OF_STREAM, status);
+}
+
+void test_readMessage_withPacketLength_tooShort() {
+    const uint8_t data[] = {0x41, 0x01, 0x01, 0x00};
+    udp.mock_setPacketToParse(data, 4);
+    const auto [message, status] = io.read(udp.parsePacket());
+    TEST_ASSERT_TRUE(bpa::isMessageEmpty(message));
+    TEST_ASSERT_EQUAL(bpa::ValidationStatus::STATUS_UNEXPECTED_END_OF_STREAM, status);
+    TEST_ASSERT_EQUAL(4, udp.available());
+}
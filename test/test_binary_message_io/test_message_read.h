@@ -5,5 +5,9 @@ void test_readMessage_withoutData();
 void test_readMessage_withData();
 void test_readMessage_incorrectStreamLength();
 void test_readMessage_invalidChecksum();
+void test_readMessage_stopsAtEndOfFrame();
+void test_readMessage_withPacketLength();
+void test_readMessage_withPacketLength_sizeMismatch();
+void test_readMessage_withPacketLength_tooShort();
 
 #endif //TEST_MESSAGE_READ_H
@@ -43,23 +43,29 @@ void test_validateMessage_invalidSize() {
     TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::BinaryMessageIO::validate(message3));
 }
 
-void test_validateMessage_handshake_sizeShouldBe3() {
+void test_validateMessage_handshake_sizeShouldBe3_5Or6() {
     uint8_t data[] = {};
     const bpa::BinaryMessage handshakeInit = {bpa::StartByte::HANDSHAKE_INIT, 1, 1, 1, data};
     const bpa::BinaryMessage handshakeResp = {bpa::StartByte::HANDSHAKE_RESP, 1, 2, 2, data};
     const bpa::BinaryMessage handshakeComplete = {bpa::StartByte::HANDSHAKE_COMPLETE, 1, 3, 4, data};
+    const bpa::BinaryMessage handshakeTooLong = {bpa::StartByte::HANDSHAKE_INIT, 1, 3, 7, data};
 
     TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::BinaryMessageIO::validate(handshakeInit));
     TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::BinaryMessageIO::validate(handshakeResp));
     TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::BinaryMessageIO::validate(handshakeComplete));
+    TEST_ASSERT_EQUAL(bpa::STATUS_INCORRECT_FORMAT, bpa::BinaryMessageIO::validate(handshakeTooLong));
 
     const bpa::BinaryMessage handshakeInit_ok = {bpa::StartByte::HANDSHAKE_INIT, 1, 4, 3, data};
     const bpa::BinaryMessage handshakeResp_ok = {bpa::StartByte::HANDSHAKE_RESP, 1, 5, 3, data};
     const bpa::BinaryMessage handshakeComplete_ok = {bpa::StartByte::HANDSHAKE_COMPLETE, 1, 6, 3, data};
+    const bpa::BinaryMessage handshakeKeepalive_ok = {bpa::StartByte::HANDSHAKE_INIT, 1, 7, 5, data};
+    const bpa::BinaryMessage handshakeExtended_ok = {bpa::StartByte::HANDSHAKE_RESP, 1, 8, 6, data};
 
     TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::BinaryMessageIO::validate(handshakeInit_ok));
     TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::BinaryMessageIO::validate(handshakeResp_ok));
     TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::BinaryMessageIO::validate(handshakeComplete_ok));
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::BinaryMessageIO::validate(handshakeKeepalive_ok));
+    TEST_ASSERT_EQUAL(bpa::STATUS_OK, bpa::BinaryMessageIO::validate(handshakeExtended_ok));
 }
 
 void test_validateMessage_ping_payloadShouldBeEmpty() {
@@ -6,7 +6,7 @@ void test_validateMessage_invalidStartByte();
 void test_validateMessage_invalidDeviceID();
 void test_validateMessage_invalidMessageID();
 void test_validateMessage_invalidSize();
-void test_validateMessage_handshake_sizeShouldBe3();
+void test_validateMessage_handshake_sizeShouldBe3_5Or6();
 void test_validateMessage_ping_payloadShouldBeEmpty();
 void test_validateMessage_confirm_payloadShouldBeEmpty();
 void test_validateMessage_rejected_payloadShouldBeEmpty();
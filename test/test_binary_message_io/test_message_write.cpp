@@ -46,6 +46,36 @@ void test_writeMessage_checksumShouldBeCalculated() {
     count = udp.mock_getWroteData(buffer, BPA_MAX_SIZE);
     const uint16_t checksum2 = buffer[count - 2] << 8 | buffer[count - 1];
 
-    TEST_ASSERT_EQUAL_HEX16(0x0097, checksum1);
-    TEST_ASSERT_EQUAL_HEX16(0x1937, checksum2);
+    TEST_ASSERT_EQUAL_HEX16(0x11A7, checksum1);
+    TEST_ASSERT_EQUAL_HEX16(0xB9A4, checksum2);
+}
+
+void test_writeMessage_singleStreamWrite() {
+    uint8_t data[] = {1, 2, 3};
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 1, 1, 3, data};
+    TEST_ASSERT_EQUAL(9, io.write(message));
+    TEST_ASSERT_EQUAL(1, udp.mock_getWriteCalls());
+}
+
+void test_encodeFrame_toBuffer() {
+    uint8_t written[BPA_MAX_SIZE] = {0};
+    uint8_t frame[16]             = {0};
+    uint8_t data[]                = {1, 2, 3};
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 1, 1, 3, data};
+
+    TEST_ASSERT_EQUAL(9, bpa::encodeFrame(message, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(0, udp.mock_getWriteCalls());
+
+    io.write(message);
+    const auto count = udp.mock_getWroteData(written, BPA_MAX_SIZE);
+    TEST_ASSERT_EQUAL(9, count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(written, frame, count);
+}
+
+void test_encodeFrame_notEnoughCapacity() {
+    uint8_t frame[8] = {0};
+    uint8_t data[]   = {1, 2, 3};
+    const bpa::BinaryMessage message = {bpa::StartByte::START_V1, 1, 1, 3, data};
+
+    TEST_ASSERT_EQUAL(0, bpa::encodeFrame(message, frame, sizeof(frame)));
 }
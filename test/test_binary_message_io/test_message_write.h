@@ -4,5 +4,8 @@
 void test_writeMessage_withoutData();
 void test_writeMessage_withData();
 void test_writeMessage_checksumShouldBeCalculated();
+void test_writeMessage_singleStreamWrite();
+void test_encodeFrame_toBuffer();
+void test_encodeFrame_notEnoughCapacity();
 
 #endif //TEST_MESSAGE_WRITE_H
@@ -0,0 +1,120 @@
+#include "test_ring_buffer.h"
+
+#include <unity.h>
+
+#include "BinaryMessageParser.h"
+#include "RingBuffer.h"
+
+static const uint8_t CONFIRM_FRAME[]  = {0x41, 0x01, 0x01, 0x00, 0xF0, 0x76};
+static const uint8_t PING_FRAME[]     = {0x50, 0x01, 0x02, 0x00, 0xE1, 0xE4};
+static const uint8_t START_V1_FRAME[] = {0x30, 0x01, 0x01, 0x03, 0x01, 0x02, 0x03, 0xB9, 0xA4};
+
+void test_ringBuffer_pushAndRead() {
+    bpa::RingBufferStream<16> ring;
+    TEST_ASSERT_EQUAL(0, ring.available());
+    TEST_ASSERT_EQUAL(-1, ring.read());
+
+    TEST_ASSERT_TRUE(ring.push(0x10));
+    TEST_ASSERT_EQUAL(2, ring.push(CONFIRM_FRAME, 2));
+    TEST_ASSERT_EQUAL(3, ring.available());
+    TEST_ASSERT_EQUAL(0x10, ring.peek());
+    TEST_ASSERT_EQUAL(0x10, ring.read());
+
+    uint8_t bytes[4];
+    TEST_ASSERT_EQUAL(2, ring.readBytes(bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(CONFIRM_FRAME, bytes, 2);
+    TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+void test_ringBuffer_overflow() {
+    bpa::RingBufferStream<8> ring;
+    TEST_ASSERT_EQUAL(6, ring.push(START_V1_FRAME, 6));
+    TEST_ASSERT_EQUAL(2, ring.push(START_V1_FRAME + 6, 3));
+    TEST_ASSERT_FALSE(ring.push(0x00));
+    TEST_ASSERT_EQUAL(8, ring.available());
+    TEST_ASSERT_EQUAL(2, ring.overflows());
+
+    ring.consume(1);
+    TEST_ASSERT_TRUE(ring.push(0x00));
+}
+
+void test_ringBuffer_wrapAround() {
+    bpa::RingBufferStream<8> ring;
+    ring.push(CONFIRM_FRAME, sizeof(CONFIRM_FRAME));
+    ring.consume(5);
+    ring.push(PING_FRAME, sizeof(PING_FRAME));
+
+    size_t contiguous;
+    const uint8_t* span = ring.span(contiguous);
+    TEST_ASSERT_EQUAL(3, contiguous);
+    TEST_ASSERT_EQUAL(0x76, span[0]);
+    TEST_ASSERT_EQUAL(7, ring.available());
+
+    uint8_t bytes[7];
+    TEST_ASSERT_EQUAL(7, ring.peekBytes(bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL(0x76, bytes[0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(PING_FRAME, bytes + 1, sizeof(PING_FRAME));
+    TEST_ASSERT_EQUAL(7, ring.available());
+}
+
+void test_parser_ringFrameInPlace() {
+    bpa::BinaryMessageParser parser;
+    bpa::RingBufferStream<512> ring;
+    ring.push(PING_FRAME, sizeof(PING_FRAME));
+    ring.push(START_V1_FRAME, sizeof(START_V1_FRAME));
+
+    size_t contiguous;
+    const uint8_t* span = ring.span(contiguous);
+
+    TEST_ASSERT_TRUE(parser.poll(ring));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, parser.message().start);
+    TEST_ASSERT_EQUAL(sizeof(PING_FRAME) + sizeof(START_V1_FRAME), ring.available()); // Not released yet
+
+    TEST_ASSERT_TRUE(parser.poll(ring));
+    const auto& message = parser.message();
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, message.start);
+    TEST_ASSERT_EQUAL(3, message.size);
+    TEST_ASSERT_EQUAL_PTR(span + sizeof(PING_FRAME) + 4, message.data);
+    TEST_ASSERT_EQUAL(sizeof(START_V1_FRAME), ring.available());
+
+    TEST_ASSERT_FALSE(parser.poll(ring));
+    TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+void test_parser_ringWrappedFrameIsCopied() {
+    bpa::BinaryMessageParser parser;
+    bpa::RingBufferStream<512> ring;
+    uint8_t filler[508] = {};
+    ring.push(filler, sizeof(filler));
+    ring.consume(sizeof(filler));
+    ring.push(START_V1_FRAME, sizeof(START_V1_FRAME));
+
+    TEST_ASSERT_TRUE(parser.poll(ring));
+    const auto& message = parser.message();
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, message.start);
+    TEST_ASSERT_EQUAL(3, message.size);
+    TEST_ASSERT_EQUAL(1, message.data[0]);
+    TEST_ASSERT_EQUAL(3, message.data[2]);
+    TEST_ASSERT_EQUAL(0, ring.available()); // Copied, released at once
+}
+
+void test_parser_ringResyncAndPartialFrame() {
+    bpa::BinaryMessageParser parser;
+    bpa::RingBufferStream<512> ring;
+    const uint8_t noise[] = {0x00, 0xFF, 0x41, 0x01, 0x01, 0x00, 0x01, 0x01}; // Noise and a broken CONFIRM
+    ring.push(noise, sizeof(noise));
+    ring.push(PING_FRAME, 3);
+
+    TEST_ASSERT_FALSE(parser.poll(ring));
+    TEST_ASSERT_EQUAL(1, parser.rejectedFrames());
+    TEST_ASSERT_EQUAL(3, ring.available()); // The partial PING stays in the ring
+
+    ring.push(PING_FRAME + 3, sizeof(PING_FRAME) - 3);
+    ring.push(CONFIRM_FRAME, sizeof(CONFIRM_FRAME));
+    TEST_ASSERT_TRUE(parser.poll(ring));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, parser.message().start);
+    TEST_ASSERT_EQUAL(2, parser.message().message_id);
+    TEST_ASSERT_TRUE(parser.poll(ring));
+    TEST_ASSERT_EQUAL(bpa::StartByte::CONFIRM, parser.message().start);
+    TEST_ASSERT_EQUAL(sizeof(noise), parser.droppedBytes());
+}
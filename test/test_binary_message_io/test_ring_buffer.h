@@ -0,0 +1,11 @@
+#ifndef TEST_RING_BUFFER_H
+#define TEST_RING_BUFFER_H
+
+void test_ringBuffer_pushAndRead();
+void test_ringBuffer_overflow();
+void test_ringBuffer_wrapAround();
+void test_parser_ringFrameInPlace();
+void test_parser_ringWrappedFrameIsCopied();
+void test_parser_ringResyncAndPartialFrame();
+
+#endif //TEST_RING_BUFFER_H
@@ -0,0 +1,99 @@
+#include "test_serializer.h"
+
+#include <unity.h>
+
+#include "Serializer.h"
+
+namespace {
+    enum class Mode : uint8_t { IDLE = 1, MEASURING = 2 };
+
+    struct Reading {
+        uint16_t sensor;
+        Mode mode;
+        float value;
+        bool valid;
+    };
+
+    using ReadingLayout = bpa::Layout<bpa::Field<&Reading::sensor>,
+                                      bpa::Field<&Reading::mode>,
+                                      bpa::Field<&Reading::value>,
+                                      bpa::Field<&Reading::valid>>;
+
+    struct Sample {
+        uint16_t sensor;
+        uint32_t timestamp;
+        int16_t delta;
+    };
+
+    using SampleLayout = bpa::Layout<bpa::Field<&Sample::sensor>,
+                                     bpa::Field<&Sample::timestamp, bpa::Varint>,
+                                     bpa::Field<&Sample::delta, bpa::Varint>>;
+
+    static_assert(ReadingLayout::FIXED_SIZE && ReadingLayout::MAX_SIZE == 8, "Fixed layout size");
+    static_assert(!SampleLayout::FIXED_SIZE && SampleLayout::MAX_SIZE == 2 + 5 + 3, "Varint layout size");
+}
+
+void test_serializer_fixedLayout() {
+    const Reading reading = {0x0102, Mode::MEASURING, 1.5f, true};
+
+    uint8_t payload[ReadingLayout::MAX_SIZE];
+    TEST_ASSERT_EQUAL(8, ReadingLayout::pack(reading, payload, sizeof(payload)));
+
+    const uint8_t expected[] = {0x01, 0x02, 0x02, 0x3F, 0xC0, 0x00, 0x00, 0x01};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, payload, sizeof(expected));
+
+    Reading decoded = {};
+    TEST_ASSERT_TRUE(ReadingLayout::unpack(payload, sizeof(payload), decoded));
+    TEST_ASSERT_EQUAL_HEX16(0x0102, decoded.sensor);
+    TEST_ASSERT_TRUE(decoded.mode == Mode::MEASURING);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, decoded.value);
+    TEST_ASSERT_TRUE(decoded.valid);
+}
+
+void test_serializer_varintLayout() {
+    const Sample sample = {7, 300, -2};
+
+    uint8_t payload[SampleLayout::MAX_SIZE];
+    TEST_ASSERT_EQUAL(5, SampleLayout::size(sample));
+    TEST_ASSERT_EQUAL(5, SampleLayout::pack(sample, payload, sizeof(payload)));
+
+    // 300 = 0b10_0101100, -2 zigzags to 3
+    const uint8_t expected[] = {0x00, 0x07, 0xAC, 0x02, 0x03};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, payload, sizeof(expected));
+
+    Sample decoded = {};
+    TEST_ASSERT_TRUE(SampleLayout::unpack(payload, 5, decoded));
+    TEST_ASSERT_EQUAL(7, decoded.sensor);
+    TEST_ASSERT_EQUAL(300, decoded.timestamp);
+    TEST_ASSERT_EQUAL(-2, decoded.delta);
+}
+
+void test_serializer_varintBoundaries() {
+    const Sample extremes = {0xFFFF, 0xFFFFFFFF, -32768};
+
+    uint8_t payload[SampleLayout::MAX_SIZE];
+    TEST_ASSERT_EQUAL(SampleLayout::MAX_SIZE, SampleLayout::pack(extremes, payload, sizeof(payload)));
+
+    Sample decoded = {};
+    TEST_ASSERT_TRUE(SampleLayout::unpack(payload, SampleLayout::MAX_SIZE, decoded));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, decoded.timestamp);
+    TEST_ASSERT_EQUAL(-32768, decoded.delta);
+
+    TEST_ASSERT_EQUAL(0, SampleLayout::pack(extremes, payload, SampleLayout::MAX_SIZE - 1));
+}
+
+void test_serializer_rejectsMalformedPayload() {
+    Reading reading = {};
+    const uint8_t shortReading[] = {0x01, 0x02, 0x02};
+    TEST_ASSERT_FALSE(ReadingLayout::unpack(shortReading, sizeof(shortReading), reading));
+
+    Sample sample = {};
+    const uint8_t truncatedVarint[] = {0x00, 0x07, 0xAC};
+    TEST_ASSERT_FALSE(SampleLayout::unpack(truncatedVarint, sizeof(truncatedVarint), sample));
+
+    const uint8_t overflowingVarint[] = {0x00, 0x07, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0x00};
+    TEST_ASSERT_FALSE(SampleLayout::unpack(overflowingVarint, sizeof(overflowingVarint), sample));
+
+    const uint8_t trailingBytes[] = {0x00, 0x07, 0x01, 0x00, 0x00};
+    TEST_ASSERT_FALSE(SampleLayout::unpack(trailingBytes, sizeof(trailingBytes), sample));
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_SERIALIZER_H
+#define TEST_SERIALIZER_H
+
+void test_serializer_fixedLayout();
+void test_serializer_varintLayout();
+void test_serializer_varintBoundaries();
+void test_serializer_rejectsMalformedPayload();
+
+#endif //TEST_SERIALIZER_H
@@ -4,9 +4,13 @@
 void test_isSupportedStartByte()
 {
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::START_V1));
+    TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::FRAGMENT_V1));
+    TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::COMPRESSED_V1));
+    TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::GROUP_V1));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::CONFIRM));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::INCORRECT_FORMAT));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::INCORRECT_CHECKSUM));
+    TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::ACKNOWLEDGE));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::PING));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::REJECTED));
     TEST_ASSERT_TRUE(bpa::isSupportedStartByte(bpa::StartByte::HANDSHAKE_INIT));
@@ -19,6 +23,21 @@ void test_isSupportedStartByte()
     TEST_ASSERT_FALSE(bpa::isSupportedStartByte(0x40));
     TEST_ASSERT_FALSE(bpa::isSupportedStartByte(0x5B));
     TEST_ASSERT_FALSE(bpa::isSupportedStartByte(0x7D));
+
+    size_t supported = 0;
+    size_t extended  = 0;
+    for (int i = 0; i < 256; i++) {
+        supported += bpa::isSupportedStartByte(static_cast<uint8_t>(i)) ? 1 : 0;
+        extended += bpa::isExtendedStartByte(static_cast<uint8_t>(i)) ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL(24, supported);
+    TEST_ASSERT_EQUAL(10, extended); // The version and control bytes
+
+    TEST_ASSERT_TRUE(bpa::isExtendedStartByte(0xB0));
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, bpa::basicStartByte(0xB0));
+    TEST_ASSERT_EQUAL(bpa::StartByte::PING, bpa::basicStartByte(bpa::extendedStartByte(bpa::StartByte::PING)));
+    TEST_ASSERT_FALSE(bpa::isSupportedStartByte(bpa::StartByte::HANDSHAKE_INIT | bpa::EXTENDED_HEADER));
+    TEST_ASSERT_FALSE(bpa::isSupportedStartByte(bpa::StartByte::DISCONNECT | bpa::EXTENDED_HEADER));
 }
 
 void test_isVersionStartByte()
@@ -36,6 +55,9 @@ void test_isVersionStartByte()
 
     TEST_ASSERT_FALSE(bpa::isVersionStartByte(0x2F));
     TEST_ASSERT_FALSE(bpa::isVersionStartByte(0x3A));
+    TEST_ASSERT_TRUE(bpa::isVersionStartByte(bpa::StartByte::FRAGMENT_V1));
+    TEST_ASSERT_TRUE(bpa::isVersionStartByte(bpa::StartByte::COMPRESSED_V1));
+    TEST_ASSERT_TRUE(bpa::isVersionStartByte(bpa::StartByte::GROUP_V1));
     TEST_ASSERT_FALSE(bpa::isVersionStartByte(0x2E));
     TEST_ASSERT_FALSE(bpa::isVersionStartByte(0x40));
     TEST_ASSERT_FALSE(bpa::isVersionStartByte(0x5B));
@@ -0,0 +1,51 @@
+#include "test_congestion.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+void test_congestion_sendMessageResults() {
+    uint8_t payload[] = {1, 2, 3};
+    TEST_ASSERT_EQUAL(bpa::SEND_FAILED, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+
+    connectToPeer();
+    for (int i = 0; i < BPA_UDP_WINDOW_SIZE; i++) {
+        TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+    }
+    TEST_ASSERT_EQUAL(bpa::SEND_WOULD_BLOCK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+
+    exchange();
+    TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+}
+
+void test_congestion_lossShrinksWindow() {
+    connectToPeer();
+
+    uint8_t payload[] = {1, 2, 3};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    udp.mock_clearSentPackets(); // The first frame is lost
+
+    // The peer reports the gap right away
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    deliver(udp, peerUdp);
+    peer->loop();
+    deliver(peerUdp, udp);
+    tunnel->loop();
+    udp.mock_clearSentPackets();
+
+    // The lost frame is still in flight within the halved window, the others wait
+    constexpr int count = 10;
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+    }
+    tunnel->flush();
+    TEST_ASSERT_EQUAL(BPA_UDP_INITIAL_CWND / 2 - 1, countSentFrames(bpa::StartByte::START_V1));
+
+    loopUntil([] {
+        exchange();
+        return peerReceived.count >= count + 1;
+    }, 1000);
+    TEST_ASSERT_EQUAL(count + 1, peerReceived.count);
+}
@@ -0,0 +1,7 @@
+#ifndef TEST_CONGESTION_H
+#define TEST_CONGESTION_H
+
+void test_congestion_sendMessageResults();
+void test_congestion_lossShrinksWindow();
+
+#endif //TEST_CONGESTION_H
@@ -0,0 +1,57 @@
+#include "test_datagram_batching.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+void test_batching_framesForSamePeerShareDatagram() {
+    const IPAddress peer(192, 168, 0, 2);
+    tunnel->connect(peer, 4210);
+    tunnel->connect(peer, 4210);
+    tunnel->loop();
+
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+    TEST_ASSERT_TRUE(peer == udp.mock_getPacketIP());
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[4];
+    TEST_ASSERT_EQUAL(2, readSentFrames(0, buffer, messages, 4));
+    TEST_ASSERT_NOT_EQUAL(messages[0].message_id, messages[1].message_id);
+}
+
+void test_batching_datagramPerPeer() {
+    tunnel->connect(IPAddress(192, 168, 0, 2), 4210);
+    tunnel->connect(IPAddress(192, 168, 0, 3), 4210);
+    tunnel->loop();
+
+    TEST_ASSERT_EQUAL(2, udp.mock_getSentPacketCount());
+}
+
+void test_batching_framesSentOnFlush() {
+    tunnel->connect(IPAddress(192, 168, 0, 2), 4210);
+    TEST_ASSERT_EQUAL(0, udp.mock_getSentPacketCount());
+
+    tunnel->flush();
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+
+    tunnel->flush();
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+}
+
+void test_batching_receivedFramesProcessedInPlace() {
+    bpa::FrameBatch<BPA_UDP_MAX_DATAGRAM_SIZE, BPA_UDP_CHECKSUM> batch;
+    batch.append({bpa::StartByte::PING, 5, 1, 0, nullptr});
+    batch.append({bpa::StartByte::PING, 5, 2, 0, nullptr});
+    udp.mock_setPacketToParse(batch.data(), batch.length());
+
+    tunnel->loop();
+
+    // Both frames come from an unknown device, the replies are packed into one datagram
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[4];
+    TEST_ASSERT_EQUAL(2, readSentFrames(0, buffer, messages, 4));
+    TEST_ASSERT_EQUAL(bpa::StartByte::DISCONNECT, messages[0].start);
+    TEST_ASSERT_EQUAL(bpa::StartByte::DISCONNECT, messages[1].start);
+    TEST_ASSERT_EQUAL(TUNNEL_ID, messages[0].device_id);
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_DATAGRAM_BATCHING_H
+#define TEST_DATAGRAM_BATCHING_H
+
+void test_batching_framesForSamePeerShareDatagram();
+void test_batching_datagramPerPeer();
+void test_batching_framesSentOnFlush();
+void test_batching_receivedFramesProcessedInPlace();
+
+#endif //TEST_DATAGRAM_BATCHING_H
@@ -0,0 +1,76 @@
+#include "test_delayed_ack.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    /**
+     * @brief Queues the given number of datagrams from the peer, one message each, in the network of the tunnel.
+     */
+    void queueDatagrams(const size_t count) {
+        uint8_t payload[] = {1, 2, 3};
+        for (size_t i = 0; i < count; i++) {
+            peer->sendMessage(TUNNEL_ID, payload, sizeof(payload));
+            peer->flush();
+        }
+        TEST_ASSERT_EQUAL(count, deliver(peerUdp, udp));
+    }
+
+    /**
+     * @brief Reads the frames of the only datagram sent by the tunnel.
+     */
+    size_t readOnlyDatagram(uint8_t* buffer, bpa::BinaryMessage* messages, const size_t capacity) {
+        TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+        return readSentFrames(0, buffer, messages, capacity);
+    }
+}
+
+void test_delayedAck_coversFramesOfSeveralDatagrams() {
+    connectToPeer();
+    queueDatagrams(BPA_UDP_ACK_FRAMES - 1);
+
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(0, udp.mock_getSentPacketCount());
+
+    waitFor(BPA_UDP_ACK_DELAY);
+    tunnel->loop();
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[4];
+    TEST_ASSERT_EQUAL(1, readOnlyDatagram(buffer, messages, 4));
+    TEST_ASSERT_EQUAL(bpa::StartByte::ACKNOWLEDGE, bpa::basicStartByte(messages[0].start));
+    TEST_ASSERT_EQUAL(2, messages[0].size); // The extended header takes a 16-bit cumulative sequence number
+    TEST_ASSERT_EQUAL(BPA_UDP_ACK_FRAMES - 1, messages[0].data[1]);
+}
+
+void test_delayedAck_sentAfterFrameLimit() {
+    connectToPeer();
+    queueDatagrams(BPA_UDP_ACK_FRAMES);
+
+    tunnel->loop();
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[4];
+    TEST_ASSERT_EQUAL(1, readOnlyDatagram(buffer, messages, 4));
+    TEST_ASSERT_EQUAL(bpa::StartByte::ACKNOWLEDGE, bpa::basicStartByte(messages[0].start));
+    TEST_ASSERT_EQUAL(BPA_UDP_ACK_FRAMES, messages[0].data[1]);
+}
+
+void test_delayedAck_piggybackedOnOutgoingFrame() {
+    connectToPeer();
+    queueDatagrams(1);
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(0, udp.mock_getSentPacketCount());
+
+    uint8_t payload[] = {4, 5, 6};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[4];
+    TEST_ASSERT_EQUAL(2, readOnlyDatagram(buffer, messages, 4));
+    TEST_ASSERT_EQUAL(bpa::StartByte::ACKNOWLEDGE, bpa::basicStartByte(messages[0].start));
+    TEST_ASSERT_EQUAL(1, messages[0].data[1]);
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, bpa::basicStartByte(messages[1].start));
+}
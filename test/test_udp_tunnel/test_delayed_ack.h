@@ -0,0 +1,8 @@
+#ifndef TEST_DELAYED_ACK_H
+#define TEST_DELAYED_ACK_H
+
+void test_delayedAck_coversFramesOfSeveralDatagrams();
+void test_delayedAck_sentAfterFrameLimit();
+void test_delayedAck_piggybackedOnOutgoingFrame();
+
+#endif //TEST_DELAYED_ACK_H
@@ -0,0 +1,74 @@
+#include "test_device_table.h"
+
+#include <unity.h>
+
+#include "DeviceTable.h"
+#include "tunnel_fixture.h"
+
+namespace {
+    struct Record {
+        uint16_t value;
+    };
+}
+
+void test_deviceTable_insertAndFind() {
+    bpa::DeviceTable<Record, 4> table;
+    TEST_ASSERT_NULL(table.find(7));
+
+    TEST_ASSERT_NOT_NULL(table.insert(7, {70}));
+    TEST_ASSERT_NOT_NULL(table.insert(255, {2550}));
+    TEST_ASSERT_EQUAL(2, table.size());
+    TEST_ASSERT_EQUAL(70, table.find(7)->value);
+    TEST_ASSERT_EQUAL(2550, table.find(255)->value);
+
+    table.insert(7, {71}); // Replaces the record
+    TEST_ASSERT_EQUAL(2, table.size());
+    TEST_ASSERT_EQUAL(71, table.find(7)->value);
+}
+
+void test_deviceTable_eraseMovesLastRecord() {
+    bpa::DeviceTable<Record, 4> table;
+    table.insert(1, {10});
+    table.insert(2, {20});
+    table.insert(3, {30});
+
+    TEST_ASSERT_TRUE(table.erase(1));
+    TEST_ASSERT_FALSE(table.erase(1));
+    TEST_ASSERT_NULL(table.find(1));
+    TEST_ASSERT_EQUAL(2, table.size());
+    TEST_ASSERT_EQUAL(3, table[0].id); // The last record took the free slot
+    TEST_ASSERT_EQUAL(30, table.find(3)->value);
+    TEST_ASSERT_EQUAL(20, table.find(2)->value);
+
+    uint16_t sum = 0;
+    for (const auto& entry: table) {
+        sum += entry.record.value;
+    }
+    TEST_ASSERT_EQUAL(50, sum);
+}
+
+void test_deviceTable_capacity() {
+    bpa::DeviceTable<Record, 2> table;
+    table.insert(1, {10});
+    table.insert(2, {20});
+    TEST_ASSERT_TRUE(table.full());
+    TEST_ASSERT_NULL(table.insert(3, {30}));
+    TEST_ASSERT_NOT_NULL(table.insert(2, {21})); // Known devices can still be updated
+
+    table.erase(1);
+    TEST_ASSERT_NOT_NULL(table.insert(3, {30}));
+}
+
+void test_deviceTable_tunnelDisconnectFreesSlot() {
+    connectToPeer();
+    TEST_ASSERT_TRUE(tunnel->isConnected(PEER_ID));
+
+    tunnel->disconnect(PEER_ID);
+    TEST_ASSERT_FALSE(tunnel->isKnownDevice(PEER_ID));
+    exchange();
+    TEST_ASSERT_FALSE(peer->isKnownDevice(TUNNEL_ID));
+
+    connectToPeer();
+    TEST_ASSERT_TRUE(tunnel->isConnected(PEER_ID));
+    TEST_ASSERT_TRUE(peer->isConnected(TUNNEL_ID));
+}
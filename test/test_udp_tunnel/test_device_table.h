@@ -0,0 +1,9 @@
+#ifndef TEST_DEVICE_TABLE_H
+#define TEST_DEVICE_TABLE_H
+
+void test_deviceTable_insertAndFind();
+void test_deviceTable_eraseMovesLastRecord();
+void test_deviceTable_capacity();
+void test_deviceTable_tunnelDisconnectFreesSlot();
+
+#endif //TEST_DEVICE_TABLE_H
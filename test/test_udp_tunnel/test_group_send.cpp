@@ -0,0 +1,78 @@
+#include "test_group_send.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    /**
+     * @brief Passes a GROUP_V1 frame listing a single recipient to the peer.
+     */
+    void receiveGroupFrame(const bpa::DeviceID from, const bpa::DeviceID recipient) {
+        uint8_t payload[] = {1, recipient, 0, 1, 'h', 'i'};
+        bpa::FrameBatch<BPA_UDP_MAX_DATAGRAM_SIZE, BPA_UDP_CHECKSUM> batch;
+        batch.append({bpa::StartByte::GROUP_V1, from, 1, sizeof(payload), payload});
+        peerUdp.mock_setPacketToParse(batch.data(), batch.length());
+        peer->loop();
+    }
+}
+
+void test_groupSend_unicastWithoutGroupAddress() {
+    connectToPeer();
+
+    uint8_t payload[] = {1, 2, 3};
+    const bpa::DeviceID group[] = {PEER_ID, 9};
+    TEST_ASSERT_EQUAL(1, tunnel->sendToGroup(group, 2, payload, sizeof(payload)));
+
+    exchange();
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, peerReceived.data, sizeof(payload));
+}
+
+void test_groupSend_sharedFrameAcknowledgedPerDevice() {
+    const IPAddress groupIP(239, 0, 0, 1);
+    tunnel->setGroupAddress(groupIP, PORT);
+    connectToPeer();
+
+    uint8_t payload[] = {1, 2, 3};
+    TEST_ASSERT_EQUAL(1, tunnel->broadcast(payload, sizeof(payload)));
+    tunnel->flush();
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[2];
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+    TEST_ASSERT_EQUAL(1, readSentFrames(0, buffer, messages, 2));
+    TEST_ASSERT_TRUE(udp.mock_getPacketIP() == groupIP);
+    TEST_ASSERT_EQUAL(bpa::StartByte::GROUP_V1, messages[0].start);
+    TEST_ASSERT_EQUAL(4 + sizeof(payload), messages[0].size);
+    TEST_ASSERT_EQUAL(1, messages[0].data[0]);
+    TEST_ASSERT_EQUAL(PEER_ID, messages[0].data[1]);
+    TEST_ASSERT_EQUAL(1, messages[0].data[2] << 8 | messages[0].data[3]);
+
+    exchange();
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+    TEST_ASSERT_EQUAL(TUNNEL_ID, peerReceived.sender);
+    TEST_ASSERT_EQUAL(sizeof(payload), peerReceived.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, peerReceived.data, sizeof(payload));
+
+    // The delayed acknowledgement of the peer frees the slot of the message in the send window
+    waitFor(BPA_UDP_ACK_DELAY);
+    exchange();
+    for (int i = 0; i < BPA_UDP_WINDOW_SIZE; i++) {
+        TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+    }
+}
+
+void test_groupSend_ignoredByOtherDevices() {
+    connectToPeer();
+
+    receiveGroupFrame(TUNNEL_ID, 9);
+    receiveGroupFrame(9, PEER_ID);
+    peer->flush();
+    TEST_ASSERT_EQUAL(0, peerReceived.count);
+    TEST_ASSERT_EQUAL(0, peerUdp.mock_getSentPacketCount()); // Neither acknowledged nor answered with DISCONNECT
+
+    receiveGroupFrame(TUNNEL_ID, PEER_ID);
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("hi", peerReceived.data, 2);
+}
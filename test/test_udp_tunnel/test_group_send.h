@@ -0,0 +1,8 @@
+#ifndef TEST_GROUP_SEND_H
+#define TEST_GROUP_SEND_H
+
+void test_groupSend_unicastWithoutGroupAddress();
+void test_groupSend_sharedFrameAcknowledgedPerDevice();
+void test_groupSend_ignoredByOtherDevices();
+
+#endif //TEST_GROUP_SEND_H
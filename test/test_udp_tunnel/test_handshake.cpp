@@ -0,0 +1,72 @@
+#include "test_handshake.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    void receiveHandshake(const bpa::StartByte start, const uint8_t versionByte) {
+        uint8_t payload[] = {versionByte, 0x12, 0x34};
+        bpa::FrameBatch<BPA_UDP_MAX_DATAGRAM_SIZE, BPA_UDP_CHECKSUM> batch;
+        batch.append({start, PEER_ID, 1, sizeof(payload), payload});
+        udp.mock_setPacketToParse(batch.data(), batch.length());
+        tunnel->loop();
+    }
+
+    bpa::StartByte replyToHandshakeInit(const uint8_t versionByte) {
+        receiveHandshake(bpa::StartByte::HANDSHAKE_INIT, versionByte);
+
+        uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+        bpa::BinaryMessage messages[1];
+        TEST_ASSERT_EQUAL(1, readSentFrames(0, buffer, messages, 1));
+        return messages[0].start;
+    }
+
+    /**
+     * @brief Sends a message to the peer and returns the start byte of the frame sent.
+     */
+    uint8_t sendToPeer() {
+        udp.mock_clearSentPackets();
+        uint8_t payload[] = {1, 2, 3};
+        tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+        tunnel->flush();
+
+        uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+        bpa::BinaryMessage messages[1];
+        TEST_ASSERT_EQUAL(1, readSentFrames(0, buffer, messages, 1));
+        return messages[0].start;
+    }
+}
+
+void test_handshake_connectsBothDevices() {
+    connectToPeer();
+
+    TEST_ASSERT_FALSE(tunnel->isLostDevice(PEER_ID));
+    TEST_ASSERT_FALSE(peer->isLostDevice(TUNNEL_ID));
+}
+
+void test_handshake_capabilitiesDoNotChangeVersion() {
+    TEST_ASSERT_EQUAL(bpa::StartByte::HANDSHAKE_RESP,
+                      replyToHandshakeInit(BPA_VERSION | bpa::udp::internal::CAPABILITY_COMPRESSION));
+}
+
+void test_handshake_rejectsUnsupportedVersion() {
+    TEST_ASSERT_EQUAL(bpa::StartByte::REJECTED, replyToHandshakeInit(BPA_VERSION + 1));
+}
+
+void test_handshake_extendedSequenceNegotiated() {
+    connectToPeer();
+
+    TEST_ASSERT_EQUAL(bpa::extendedStartByte(bpa::StartByte::START_V1), sendToPeer());
+    exchange();
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+}
+
+void test_handshake_basicSequenceWithoutExtensions() {
+    // Devices without the extensions byte send a 3-byte handshake
+    TEST_ASSERT_EQUAL(bpa::StartByte::HANDSHAKE_RESP, replyToHandshakeInit(BPA_VERSION));
+    receiveHandshake(bpa::StartByte::HANDSHAKE_COMPLETE, BPA_VERSION);
+    TEST_ASSERT_TRUE(tunnel->isConnected(PEER_ID));
+
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, sendToPeer());
+}
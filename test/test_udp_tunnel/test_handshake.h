@@ -0,0 +1,10 @@
+#ifndef TEST_HANDSHAKE_H
+#define TEST_HANDSHAKE_H
+
+void test_handshake_connectsBothDevices();
+void test_handshake_capabilitiesDoNotChangeVersion();
+void test_handshake_rejectsUnsupportedVersion();
+void test_handshake_extendedSequenceNegotiated();
+void test_handshake_basicSequenceWithoutExtensions();
+
+#endif //TEST_HANDSHAKE_H
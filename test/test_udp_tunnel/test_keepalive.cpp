@@ -0,0 +1,44 @@
+#include "test_keepalive.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    /**
+     * @brief Passes a handshake frame from the peer, announcing a keepalive interval of 10 seconds, to the tunnel.
+     */
+    void receiveHandshake(const bpa::StartByte start) {
+        uint8_t payload[] = {BPA_VERSION | bpa::udp::internal::CAPABILITY_KEEPALIVE, 0x12, 0x34, 0x27, 0x10};
+        bpa::FrameBatch<BPA_UDP_MAX_DATAGRAM_SIZE, BPA_UDP_CHECKSUM> batch;
+        batch.append({start, PEER_ID, 1, sizeof(payload), payload});
+        udp.mock_setPacketToParse(batch.data(), batch.length());
+        tunnel->loop();
+    }
+}
+
+void test_keepalive_startsAtShortestInterval() {
+    connectToPeer();
+
+    const auto now = GET_CURRENT_TIMESTAMP();
+    TEST_ASSERT_TRUE(tunnel->nextExpiry() - now <= BPA_UDP_KEEPALIVE_MIN + 1);
+}
+
+void test_keepalive_negotiatedInHandshake() {
+    receiveHandshake(bpa::StartByte::HANDSHAKE_INIT);
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    bpa::BinaryMessage messages[1];
+    TEST_ASSERT_EQUAL(1, readSentFrames(0, buffer, messages, 1));
+    TEST_ASSERT_EQUAL(bpa::StartByte::HANDSHAKE_RESP, messages[0].start);
+    TEST_ASSERT_EQUAL(6, messages[0].size);
+    TEST_ASSERT_TRUE(messages[0].data[0] & bpa::udp::internal::CAPABILITY_KEEPALIVE);
+    TEST_ASSERT_EQUAL(BPA_UDP_KEEPALIVE_MIN, messages[0].data[3] << 8 | messages[0].data[4]);
+
+    receiveHandshake(bpa::StartByte::HANDSHAKE_COMPLETE);
+    TEST_ASSERT_TRUE(tunnel->isConnected(PEER_ID));
+
+    // The peer is not pinged before its own interval
+    const auto now = GET_CURRENT_TIMESTAMP();
+    TEST_ASSERT_TRUE(tunnel->nextExpiry() - now >= 10000);
+}
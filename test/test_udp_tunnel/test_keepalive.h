@@ -0,0 +1,7 @@
+#ifndef TEST_KEEPALIVE_H
+#define TEST_KEEPALIVE_H
+
+void test_keepalive_startsAtShortestInterval();
+void test_keepalive_negotiatedInHandshake();
+
+#endif //TEST_KEEPALIVE_H
@@ -0,0 +1,61 @@
+#include "test_loop_budget.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    size_t receivedCount = 0; ///< The number of messages delivered to the tunnel under test
+
+    void countReceived(bpa::DeviceID, uint8_t*, bpa::MessageSize) {
+        receivedCount++;
+    }
+
+    /**
+     * @brief Queues the given number of datagrams from the peer, one message each, in the network of the tunnel.
+     */
+    void queueDatagrams(const size_t count) {
+        uint8_t payload[] = {1, 2, 3};
+        for (size_t i = 0; i < count; i++) {
+            peer->sendMessage(TUNNEL_ID, payload, sizeof(payload));
+            peer->flush();
+        }
+        TEST_ASSERT_EQUAL(count, deliver(peerUdp, udp));
+    }
+}
+
+void test_loopBudget_drainsUpToPacketBudget() {
+    connectToPeer();
+    tunnel->onMessageReceived(countReceived);
+    receivedCount = 0;
+    queueDatagrams(5);
+
+    auto result = tunnel->loop(2, 1000);
+    TEST_ASSERT_EQUAL(2, result.packets);
+    TEST_ASSERT_TRUE(result.morePending);
+    TEST_ASSERT_EQUAL(2, receivedCount);
+
+    result = tunnel->loop(10, 1000);
+    TEST_ASSERT_EQUAL(3, result.packets);
+    TEST_ASSERT_FALSE(result.morePending);
+    TEST_ASSERT_EQUAL(5, receivedCount);
+
+    result = tunnel->loop(10, 1000);
+    TEST_ASSERT_EQUAL(0, result.packets);
+    TEST_ASSERT_FALSE(result.morePending);
+}
+
+void test_loopBudget_readsOneDatagramWithoutTime() {
+    connectToPeer();
+    tunnel->onMessageReceived(countReceived);
+    receivedCount = 0;
+    queueDatagrams(2);
+
+    const auto result = tunnel->loop(10, 0);
+    TEST_ASSERT_EQUAL(1, result.packets);
+    TEST_ASSERT_TRUE(result.morePending);
+    TEST_ASSERT_EQUAL(1, receivedCount);
+
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(2, receivedCount);
+}
@@ -0,0 +1,7 @@
+#ifndef TEST_LOOP_BUDGET_H
+#define TEST_LOOP_BUDGET_H
+
+void test_loopBudget_drainsUpToPacketBudget();
+void test_loopBudget_readsOneDatagramWithoutTime();
+
+#endif //TEST_LOOP_BUDGET_H
@@ -0,0 +1,119 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <MockUdp.h>
+#include "tunnel_fixture.h"
+#include "test_datagram_batching.h"
+#include "test_handshake.h"
+#include "test_message_delivery.h"
+#include "test_device_table.h"
+#include "test_sliding_window.h"
+#include "test_timer_wheel.h"
+#include "test_loop_budget.h"
+#include "test_reliable_delivery.h"
+#include "test_delayed_ack.h"
+#include "test_keepalive.h"
+#include "test_send_queue.h"
+#include "test_congestion.h"
+#include "test_group_send.h"
+
+MockUDP udp;
+MockUDP peerUdp;
+
+bpa::udp::UDPTunnel* tunnel = nullptr;
+bpa::udp::UDPTunnel* peer   = nullptr;
+
+void onPeerMessage(const bpa::DeviceID sender, uint8_t* data, const bpa::MessageSize size)
+{
+    peerReceived.count++;
+    peerReceived.sender = sender;
+    peerReceived.size = size;
+    memcpy(peerReceived.data, data, size);
+}
+
+void setUp()
+{
+    udp.mock_setRemoteIP(PEER_IP);
+    udp.mock_setRemotePort(PORT);
+    peerUdp.mock_setRemoteIP(TUNNEL_IP);
+    peerUdp.mock_setRemotePort(PORT);
+
+    tunnel = new bpa::udp::UDPTunnel(udp, TUNNEL_ID);
+    peer = new bpa::udp::UDPTunnel(peerUdp, PEER_ID);
+    peer->onMessageReceived(onPeerMessage);
+    peerReceived = {};
+}
+
+void tearDown()
+{
+    delete tunnel;
+    delete peer;
+    tunnel = nullptr;
+    peer = nullptr;
+    udp.mock_reset();
+    peerUdp.mock_reset();
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(2000); // service delay
+    UNITY_BEGIN();
+
+    RUN_TEST(test_batching_framesForSamePeerShareDatagram);
+    RUN_TEST(test_batching_datagramPerPeer);
+    RUN_TEST(test_batching_framesSentOnFlush);
+    RUN_TEST(test_batching_receivedFramesProcessedInPlace);
+    RUN_TEST(test_handshake_connectsBothDevices);
+    RUN_TEST(test_handshake_capabilitiesDoNotChangeVersion);
+    RUN_TEST(test_handshake_rejectsUnsupportedVersion);
+    RUN_TEST(test_handshake_extendedSequenceNegotiated);
+    RUN_TEST(test_handshake_basicSequenceWithoutExtensions);
+    RUN_TEST(test_delivery_compressedWhenSmaller);
+    RUN_TEST(test_delivery_incompressibleSentRaw);
+    RUN_TEST(test_delivery_fragmentedMessage);
+    RUN_TEST(test_delivery_handlesHeldWithoutCopy);
+    RUN_TEST(test_delivery_duplicatesAcknowledgedNotDelivered);
+    RUN_TEST(test_delivery_duplicateAcknowledgedWithFullPool);
+    RUN_TEST(test_deviceTable_insertAndFind);
+    RUN_TEST(test_deviceTable_eraseMovesLastRecord);
+    RUN_TEST(test_deviceTable_capacity);
+    RUN_TEST(test_deviceTable_tunnelDisconnectFreesSlot);
+    RUN_TEST(test_slidingWindow_cumulativeAndSelective);
+    RUN_TEST(test_slidingWindow_dropOldestFirst);
+    RUN_TEST(test_slidingWindow_receiverReportsGaps);
+    RUN_TEST(test_slidingWindow_sequenceSkipsZero);
+    RUN_TEST(test_slidingWindow_extendedSequenceWraps);
+    RUN_TEST(test_slidingWindow_tunnelAcknowledgesAfterLoss);
+    RUN_TEST(test_slidingWindow_tunnelRejectsWhenFull);
+    RUN_TEST(test_timerWheel_expiresOnlyDueTimers);
+    RUN_TEST(test_timerWheel_laterRotationStaysScheduled);
+    RUN_TEST(test_timerWheel_callbackRemovesAndReschedules);
+    RUN_TEST(test_timerWheel_nextExpiry);
+    RUN_TEST(test_timerWheel_tunnelSchedulesDeviceTimeouts);
+    RUN_TEST(test_loopBudget_drainsUpToPacketBudget);
+    RUN_TEST(test_loopBudget_readsOneDatagramWithoutTime);
+    RUN_TEST(test_reliable_rttEstimator);
+    RUN_TEST(test_reliable_retransmitsLostFrame);
+    RUN_TEST(test_reliable_disabledByDefault);
+    RUN_TEST(test_delayedAck_coversFramesOfSeveralDatagrams);
+    RUN_TEST(test_delayedAck_sentAfterFrameLimit);
+    RUN_TEST(test_delayedAck_piggybackedOnOutgoingFrame);
+    RUN_TEST(test_keepalive_startsAtShortestInterval);
+    RUN_TEST(test_keepalive_negotiatedInHandshake);
+    RUN_TEST(test_sendQueue_deviceRateLimitPacesFrames);
+    RUN_TEST(test_sendQueue_controlFramesNotDelayed);
+    RUN_TEST(test_sendQueue_controlFramesUseAllowance);
+    RUN_TEST(test_sendQueue_keptWhenPingFillsWindow);
+    RUN_TEST(test_sendQueue_rejectsWhenFull);
+    RUN_TEST(test_congestion_sendMessageResults);
+    RUN_TEST(test_congestion_lossShrinksWindow);
+    RUN_TEST(test_groupSend_unicastWithoutGroupAddress);
+    RUN_TEST(test_groupSend_sharedFrameAcknowledgedPerDevice);
+    RUN_TEST(test_groupSend_ignoredByOtherDevices);
+
+    UNITY_END(); // stop unit testing
+}
+
+void loop()
+{
+}
@@ -0,0 +1,187 @@
+#include "test_message_delivery.h"
+
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    /**
+     * @brief Sends the message to the peer and returns the start byte of the first frame sent.
+     */
+    bpa::StartByte sendToPeer(uint8_t* message, const bpa::MessageSize size) {
+        tunnel->sendMessage(PEER_ID, message, size);
+        tunnel->flush();
+
+        uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+        bpa::BinaryMessage messages[2];
+        TEST_ASSERT_TRUE(readSentFrames(0, buffer, messages, 2) > 0);
+        const auto start = bpa::basicStartByte(messages[0].start);
+
+        exchange();
+        TEST_ASSERT_EQUAL(1, peerReceived.count);
+        TEST_ASSERT_EQUAL(TUNNEL_ID, peerReceived.sender);
+        TEST_ASSERT_EQUAL(size, peerReceived.size);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(message, peerReceived.data, size);
+        return start;
+    }
+
+    /**
+     * @brief Sends the message to the peer, then passes the same datagrams to the peer again as if they were resent.
+     * @return The number of datagrams the peer answered the duplicates with.
+     */
+    size_t sendTwiceToPeer(uint8_t* message, const bpa::MessageSize size) {
+        tunnel->sendMessage(PEER_ID, message, size);
+        tunnel->flush();
+
+        static uint8_t datagrams[8][BPA_UDP_MAX_DATAGRAM_SIZE];
+        size_t lengths[8];
+        const auto count = udp.mock_getSentPacketCount();
+        TEST_ASSERT_TRUE(count <= 8);
+        for (size_t i = 0; i < count; i++) {
+            lengths[i] = udp.mock_getSentPacket(i, datagrams[i], BPA_UDP_MAX_DATAGRAM_SIZE);
+        }
+        exchange();
+        TEST_ASSERT_EQUAL(1, peerReceived.count);
+
+        for (size_t i = 0; i < count; i++) {
+            peerUdp.mock_addPacketToParse(datagrams[i], lengths[i]);
+        }
+        peer->loop();
+        peer->loop(); // Sends the acknowledgement scheduled by the duplicates
+        const auto answers = peerUdp.mock_getSentPacketCount();
+        exchange();
+        return answers;
+    }
+
+    bpa::MessageHandle heldMessages[BPA_MESSAGE_POOL_SLOTS]; ///< The handles kept by the peer
+    size_t heldCount    = 0;                                ///< The number of kept handles
+    size_t droppedCount = 0;                                ///< The number of MESSAGE_DROPPED errors
+
+    void holdMessage(bpa::MessageHandle& handle) {
+        heldMessages[heldCount++] = std::move(handle);
+    }
+
+    void countDropped(bpa::DeviceID, const bpa::ErrorCode code, const char*) {
+        droppedCount += code == bpa::MESSAGE_DROPPED ? 1 : 0;
+    }
+}
+
+void test_delivery_compressedWhenSmaller() {
+    connectToPeer();
+
+    uint8_t telemetry[200];
+    for (size_t i = 0; i < sizeof(telemetry); i++) {
+        telemetry[i] = i % 8 < 4 ? 0x00 : static_cast<uint8_t>(i / 40);
+    }
+    TEST_ASSERT_EQUAL(bpa::StartByte::COMPRESSED_V1, sendToPeer(telemetry, sizeof(telemetry)));
+}
+
+void test_delivery_incompressibleSentRaw() {
+    connectToPeer();
+
+    uint8_t noise[64];
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        noise[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    TEST_ASSERT_EQUAL(bpa::StartByte::START_V1, sendToPeer(noise, sizeof(noise)));
+}
+
+void test_delivery_fragmentedMessage() {
+    connectToPeer();
+
+    uint8_t blob[700];
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = static_cast<uint8_t>(i * 13);
+    }
+    TEST_ASSERT_EQUAL(bpa::StartByte::FRAGMENT_V1, sendToPeer(blob, sizeof(blob)));
+}
+
+void test_delivery_handlesHeldWithoutCopy() {
+    connectToPeer();
+    peer->onMessageReceived(holdMessage);
+    peer->onError(countDropped);
+    heldCount    = 0;
+    droppedCount = 0;
+
+    uint8_t payload[32];
+    for (size_t i = 0; i <= BPA_MESSAGE_POOL_SLOTS; i++) {
+        for (size_t j = 0; j < sizeof(payload); j++) {
+            payload[j] = static_cast<uint8_t>(i + j * 37);
+        }
+        tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+        exchange();
+    }
+
+    // Read the kept messages and release them before asserting, the pool is owned by the peer
+    const auto sender   = heldMessages[0].device();
+    const auto size     = heldMessages[0].size();
+    const auto firstEnd = heldMessages[0].data()[sizeof(payload) - 1];
+    const auto lastEnd  = heldMessages[BPA_MESSAGE_POOL_SLOTS - 1].data()[sizeof(payload) - 1];
+    for (auto& handle: heldMessages) {
+        handle.reset();
+    }
+
+    TEST_ASSERT_EQUAL(BPA_MESSAGE_POOL_SLOTS, heldCount);
+    TEST_ASSERT_EQUAL(1, droppedCount);
+    TEST_ASSERT_EQUAL(BPA_MESSAGE_POOL_SLOTS + 1, peerReceived.count);
+    TEST_ASSERT_EQUAL(TUNNEL_ID, sender);
+    TEST_ASSERT_EQUAL(sizeof(payload), size);
+    TEST_ASSERT_EQUAL(static_cast<uint8_t>(31 * 37), firstEnd);
+    TEST_ASSERT_EQUAL(static_cast<uint8_t>(BPA_MESSAGE_POOL_SLOTS - 1 + 31 * 37), lastEnd);
+}
+
+void test_delivery_duplicatesAcknowledgedNotDelivered() {
+    connectToPeer();
+
+    uint8_t noise[64];
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        noise[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    TEST_ASSERT_TRUE(sendTwiceToPeer(noise, sizeof(noise)) > 0);
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+
+    uint8_t telemetry[200] = {};
+    peerReceived.count = 0;
+    TEST_ASSERT_TRUE(sendTwiceToPeer(telemetry, sizeof(telemetry)) > 0);
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+
+    uint8_t blob[700];
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = static_cast<uint8_t>(i * 13);
+    }
+    peerReceived.count = 0;
+    TEST_ASSERT_TRUE(sendTwiceToPeer(blob, sizeof(blob)) > 0);
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(blob, peerReceived.data, sizeof(blob));
+}
+
+void test_delivery_duplicateAcknowledgedWithFullPool() {
+    connectToPeer();
+    peer->onMessageReceived(holdMessage);
+    peer->onError(countDropped);
+    heldCount    = 0;
+    droppedCount = 0;
+
+    uint8_t noise[64];
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        noise[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    for (size_t i = 1; i < BPA_MESSAGE_POOL_SLOTS; i++) {
+        tunnel->sendMessage(PEER_ID, noise, sizeof(noise));
+        exchange();
+    }
+
+    // The compressed message takes the last slot, its duplicate still gets an acknowledgement
+    uint8_t telemetry[200] = {};
+    peerReceived.count = 0;
+    const auto answers = sendTwiceToPeer(telemetry, sizeof(telemetry));
+    const auto held    = heldCount;
+    for (auto& handle: heldMessages) {
+        handle.reset();
+    }
+
+    TEST_ASSERT_TRUE(answers > 0);
+    TEST_ASSERT_EQUAL(BPA_MESSAGE_POOL_SLOTS, held);
+    TEST_ASSERT_EQUAL(0, droppedCount);
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+}
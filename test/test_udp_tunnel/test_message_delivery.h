@@ -0,0 +1,11 @@
+#ifndef TEST_MESSAGE_DELIVERY_H
+#define TEST_MESSAGE_DELIVERY_H
+
+void test_delivery_compressedWhenSmaller();
+void test_delivery_incompressibleSentRaw();
+void test_delivery_fragmentedMessage();
+void test_delivery_handlesHeldWithoutCopy();
+void test_delivery_duplicatesAcknowledgedNotDelivered();
+void test_delivery_duplicateAcknowledgedWithFullPool();
+
+#endif //TEST_MESSAGE_DELIVERY_H
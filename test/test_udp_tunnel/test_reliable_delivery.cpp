@@ -0,0 +1,92 @@
+#include "test_reliable_delivery.h"
+
+#include <unity.h>
+#include <RttEstimator.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    /**
+     * @brief Sends a message from the tunnel to the peer and runs both tunnels until it is acknowledged.
+     */
+    void sendAcknowledged(uint8_t* payload, const size_t size) {
+        tunnel->sendMessage(PEER_ID, payload, size);
+        tunnel->flush();
+        exchange();
+        waitFor(BPA_UDP_ACK_DELAY);
+        exchange();
+    }
+
+    /**
+     * @brief Sends a message from the tunnel to the peer and drops the datagram carrying it.
+     */
+    void sendLost(uint8_t* payload, const size_t size) {
+        tunnel->sendMessage(PEER_ID, payload, size);
+        tunnel->flush();
+        TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+        udp.mock_clearSentPackets();
+    }
+}
+
+void test_reliable_rttEstimator() {
+    bpa::RttEstimator rtt;
+    TEST_ASSERT_EQUAL(1000, rtt.timeout(1000, 50, 4000));
+
+    rtt.sample(100);
+    TEST_ASSERT_EQUAL(100, rtt.srtt());
+    TEST_ASSERT_EQUAL(50, rtt.rttvar());
+    TEST_ASSERT_EQUAL(300, rtt.timeout(1000, 50, 4000));
+    TEST_ASSERT_EQUAL(200, rtt.timeout(1000, 50, 200));
+
+    // A steady RTT shrinks the variation by a quarter per sample
+    rtt.sample(100);
+    TEST_ASSERT_EQUAL(100, rtt.srtt());
+    TEST_ASSERT_EQUAL(250, rtt.timeout(1000, 50, 4000));
+
+    // A late sample moves the average by an eighth of the difference
+    rtt.sample(900);
+    TEST_ASSERT_EQUAL(200, rtt.srtt());
+}
+
+void test_reliable_retransmitsLostFrame() {
+    connectToPeer();
+    tunnel->setReliableDelivery(true);
+
+    // The first round trip, acknowledged after BPA_UDP_ACK_DELAY, brings the timeout well below BPA_LOST_PACKET_TIMEOUT
+    uint8_t first[] = {1, 2, 3};
+    sendAcknowledged(first, sizeof(first));
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+
+    uint8_t second[] = {4, 5, 6, 7};
+    sendLost(second, sizeof(second));
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(0, udp.mock_getSentPacketCount());
+
+    // The first sample sets the timeout to three times the round trip (RFC 6298), the held acknowledgement included
+    const auto lostAt = GET_CURRENT_TIMESTAMP();
+    TEST_ASSERT_TRUE(loopUntil([] {
+        tunnel->loop();
+        return udp.mock_getSentPacketCount() > 0;
+    }, 3 * (BPA_UDP_ACK_DELAY + 2 * BPA_UDP_TIMER_RESOLUTION)));
+    TEST_ASSERT_TRUE(GET_CURRENT_TIMESTAMP() - lostAt >= BPA_UDP_MIN_RTO);
+    TEST_ASSERT_EQUAL(1, udp.mock_getSentPacketCount());
+
+    exchange();
+    TEST_ASSERT_EQUAL(2, peerReceived.count);
+    TEST_ASSERT_EQUAL(sizeof(second), peerReceived.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second, peerReceived.data, sizeof(second));
+}
+
+void test_reliable_disabledByDefault() {
+    connectToPeer();
+
+    uint8_t first[] = {1, 2, 3};
+    sendAcknowledged(first, sizeof(first));
+
+    uint8_t second[] = {4, 5, 6, 7};
+    sendLost(second, sizeof(second));
+    waitFor(BPA_UDP_MIN_RTO);
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(0, udp.mock_getSentPacketCount());
+    TEST_ASSERT_EQUAL(1, peerReceived.count);
+}
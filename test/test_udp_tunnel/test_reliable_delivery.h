@@ -0,0 +1,8 @@
+#ifndef TEST_RELIABLE_DELIVERY_H
+#define TEST_RELIABLE_DELIVERY_H
+
+void test_reliable_rttEstimator();
+void test_reliable_retransmitsLostFrame();
+void test_reliable_disabledByDefault();
+
+#endif //TEST_RELIABLE_DELIVERY_H
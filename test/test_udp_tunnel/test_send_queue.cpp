@@ -0,0 +1,146 @@
+#include "test_send_queue.h"
+
+#include <cstring>
+#include <unity.h>
+
+#include "tunnel_fixture.h"
+
+namespace {
+    size_t fullCount = 0; ///< The number of SEND_WINDOW_FULL errors
+
+    void countFull(bpa::DeviceID, const bpa::ErrorCode code, const char*) {
+        fullCount += code == bpa::SEND_WINDOW_FULL ? 1 : 0;
+    }
+}
+
+void test_sendQueue_deviceRateLimitPacesFrames() {
+    connectToPeer();
+    // One frame of three bytes per 20 milliseconds
+    constexpr auto frame = bpa::frameLength<BPA_UDP_CHECKSUM>(3);
+    tunnel->setDeviceRateLimit(frame * 50, frame);
+
+    uint8_t payload[] = {1, 2, 3};
+    for (int i = 0; i < 3; i++) {
+        tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    }
+    tunnel->flush();
+    TEST_ASSERT_EQUAL(1, countSentFrames(bpa::StartByte::START_V1));
+
+    const auto start = GET_CURRENT_TIMESTAMP();
+    loopUntil([] {
+        exchange();
+        return peerReceived.count >= 3;
+    }, 1000);
+    TEST_ASSERT_EQUAL(3, peerReceived.count);
+    TEST_ASSERT_TRUE(GET_CURRENT_TIMESTAMP() - start >= 2 * 20);
+}
+
+void test_sendQueue_controlFramesNotDelayed() {
+    connectToPeer();
+    tunnel->setRateLimit(1, 1);
+
+    uint8_t payload[] = {1, 2, 3};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    udp.mock_clearSentPackets();
+
+    // The acknowledgement of the peer's frames goes out while the second message waits
+    for (int i = 0; i < BPA_UDP_ACK_FRAMES; i++) {
+        peer->sendMessage(TUNNEL_ID, payload, sizeof(payload));
+    }
+    peer->flush();
+    deliver(peerUdp, udp);
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(1, countSentFrames(bpa::StartByte::ACKNOWLEDGE));
+    TEST_ASSERT_EQUAL(0, countSentFrames(bpa::StartByte::START_V1));
+}
+
+void test_sendQueue_controlFramesUseAllowance() {
+    connectToPeer();
+    constexpr auto frame = bpa::frameLength<BPA_UDP_CHECKSUM>(3);
+    tunnel->setDeviceRateLimit(frame * 50, frame);
+
+    // The acknowledgement takes most of the burst, the message has to wait for the bucket to refill
+    uint8_t payload[] = {1, 2, 3};
+    for (int i = 0; i < BPA_UDP_ACK_FRAMES; i++) {
+        peer->sendMessage(TUNNEL_ID, payload, sizeof(payload));
+    }
+    peer->flush();
+    deliver(peerUdp, udp);
+    tunnel->loop();
+    TEST_ASSERT_EQUAL(1, countSentFrames(bpa::StartByte::ACKNOWLEDGE));
+    udp.mock_clearSentPackets();
+
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    TEST_ASSERT_EQUAL(0, countSentFrames(bpa::StartByte::START_V1));
+}
+
+void test_sendQueue_keptWhenPingFillsWindow() {
+    connectToPeer();
+    tunnel->setReliableDelivery(true);
+
+    // A measured round trip keeps the lost frame in flight, retransmitted, beyond the keepalive interval
+    uint8_t payload[] = {1, 2, 3};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    exchange();
+    waitFor(BPA_UDP_ACK_DELAY);
+    exchange();
+
+    // The peer acknowledges the frames after the lost one, which holds the window back
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    udp.mock_clearSentPackets();
+    for (int i = 0; i < BPA_UDP_WINDOW_SIZE - 3; i++) {
+        TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, payload, sizeof(payload)));
+        // Acknowledged in batches, the retransmit slots do not hold all of them
+        if (i % (BPA_UDP_RETRANSMIT_SLOTS / 2) == 0 || i == BPA_UDP_WINDOW_SIZE - 4) {
+            tunnel->flush();
+            deliver(udp, peerUdp);
+            peer->loop();
+            deliver(peerUdp, udp);
+            tunnel->loop();
+        }
+    }
+
+    // The last slot of the window is taken by a queued message
+    constexpr auto frame = bpa::frameLength<BPA_UDP_CHECKSUM>(3);
+    tunnel->setDeviceRateLimit(1, frame);
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    uint8_t last[] = {7, 8, 9};
+    TEST_ASSERT_EQUAL(bpa::SEND_OK, tunnel->sendMessage(PEER_ID, last, sizeof(last)));
+
+    // The ping takes the slot, the queued message waits for the window to move on
+    TEST_ASSERT_TRUE(loopUntil([] {
+        udp.mock_clearSentPackets();
+        tunnel->loop();
+        return countSentFrames(bpa::StartByte::PING) > 0;
+    }, 2 * BPA_UDP_KEEPALIVE_MIN));
+    tunnel->setDeviceRateLimit(0, 0);
+    tunnel->flush();
+
+    TEST_ASSERT_TRUE(loopUntil([&last] {
+        exchange();
+        return memcmp(peerReceived.data, last, sizeof(last)) == 0;
+    }, 2 * BPA_UDP_KEEPALIVE_MIN));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(last, peerReceived.data, sizeof(last));
+}
+
+void test_sendQueue_rejectsWhenFull() {
+    connectToPeer();
+    tunnel->onError(countFull);
+    fullCount = 0;
+    tunnel->setRateLimit(1, 1);
+
+    // The first frame leaves with the full bucket, the following ones fill the queue
+    uint8_t payload[] = {1, 2, 3};
+    for (int i = 0; i < BPA_UDP_QUEUE_SLOTS + 1; i++) {
+        tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    }
+    TEST_ASSERT_EQUAL(0, fullCount);
+
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(1, fullCount);
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_SEND_QUEUE_H
+#define TEST_SEND_QUEUE_H
+
+void test_sendQueue_deviceRateLimitPacesFrames();
+void test_sendQueue_controlFramesNotDelayed();
+void test_sendQueue_controlFramesUseAllowance();
+void test_sendQueue_keptWhenPingFillsWindow();
+void test_sendQueue_rejectsWhenFull();
+
+#endif //TEST_SEND_QUEUE_H
@@ -0,0 +1,152 @@
+#include "test_sliding_window.h"
+
+#include <unity.h>
+
+#include "SlidingWindow.h"
+#include "tunnel_fixture.h"
+
+namespace {
+    size_t fullCount = 0; ///< The number of SEND_WINDOW_FULL errors
+
+    void countFull(bpa::DeviceID, const bpa::ErrorCode code, const char*) {
+        fullCount += code == bpa::SEND_WINDOW_FULL ? 1 : 0;
+    }
+}
+
+void test_slidingWindow_cumulativeAndSelective() {
+    bpa::SendWindow<4> window;
+    for (uint8_t i = 1; i <= 4; i++) {
+        TEST_ASSERT_EQUAL(i, window.push(0));
+    }
+    TEST_ASSERT_EQUAL(0, window.push(0));
+
+    // Frame 2 is missing, frame 3 arrived
+    TEST_ASSERT_EQUAL(2, window.acknowledge(1, 0x02));
+    TEST_ASSERT_EQUAL(2, window.oldest());
+    TEST_ASSERT_EQUAL(3, window.inFlight());
+    TEST_ASSERT_EQUAL(1, window.available());
+
+    TEST_ASSERT_TRUE(window.acknowledge(2));
+    TEST_ASSERT_FALSE(window.acknowledge(2));
+    TEST_ASSERT_EQUAL(4, window.oldest());
+
+    // A late report of frames acknowledged already changes nothing
+    TEST_ASSERT_EQUAL(0, window.acknowledge(1, 0x02));
+    TEST_ASSERT_EQUAL(1, window.acknowledge(4, 0));
+    TEST_ASSERT_EQUAL(0, window.inFlight());
+}
+
+void test_slidingWindow_dropOldestFirst() {
+    bpa::SendWindow<4> window;
+    window.push(0, 7);
+    window.push(500);
+    window.push(600);
+    window.acknowledge(2);
+
+    auto frame = window.oldestFrame();
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(0, frame->sentAt);
+    TEST_ASSERT_EQUAL(7, frame->tag);
+    TEST_ASSERT_EQUAL(1, window.dropOldest());
+    TEST_ASSERT_EQUAL(3, window.oldest()); // Frame 2 was acknowledged already
+
+    frame = window.oldestFrame();
+    TEST_ASSERT_EQUAL(600, frame->sentAt);
+    TEST_ASSERT_EQUAL(3, window.dropOldest());
+    TEST_ASSERT_NULL(window.oldestFrame());
+    TEST_ASSERT_EQUAL(0, window.dropOldest());
+    TEST_ASSERT_EQUAL(0, window.inFlight());
+}
+
+void test_slidingWindow_receiverReportsGaps() {
+    bpa::ReceiveWindow window;
+    TEST_ASSERT_EQUAL(255, window.cumulative()); // Nothing received yet
+
+    TEST_ASSERT_TRUE(window.accept(1));
+    TEST_ASSERT_TRUE(window.accept(3));
+    TEST_ASSERT_TRUE(window.accept(4));
+    TEST_ASSERT_FALSE(window.accept(3));
+    TEST_ASSERT_EQUAL(1, window.cumulative());
+    TEST_ASSERT_EQUAL_HEX32(0x06, window.selective());
+
+    TEST_ASSERT_TRUE(window.contains(3));
+    TEST_ASSERT_FALSE(window.contains(2));
+    TEST_ASSERT_FALSE(window.contains(40)); // Beyond the selective bits, not received yet
+    TEST_ASSERT_TRUE(window.accept(2));
+    TEST_ASSERT_FALSE(window.accept(1));
+    TEST_ASSERT_TRUE(window.contains(1));
+    TEST_ASSERT_EQUAL(4, window.cumulative());
+    TEST_ASSERT_EQUAL_HEX32(0, window.selective());
+}
+
+void test_slidingWindow_sequenceSkipsZero() {
+    bpa::SendWindow<2> sent;
+    bpa::ReceiveWindow received;
+    for (int i = 0; i < 300; i++) {
+        const auto sequence = sent.push(0);
+        TEST_ASSERT_NOT_EQUAL(0, sequence);
+        TEST_ASSERT_TRUE(received.accept(sequence));
+        TEST_ASSERT_EQUAL(1, sent.acknowledge(received.cumulative(), received.selective()));
+    }
+    TEST_ASSERT_EQUAL(bpa::advanceSequence(1, 300 % 255), sent.oldest());
+}
+
+void test_slidingWindow_extendedSequenceWraps() {
+    bpa::SendWindow<2> sent(bpa::EXTENDED_SEQUENCE_LIMIT);
+    bpa::ReceiveWindow received(bpa::EXTENDED_SEQUENCE_LIMIT);
+    TEST_ASSERT_EQUAL(bpa::EXTENDED_SEQUENCE_LIMIT, received.cumulative()); // Nothing received yet
+    for (long i = 0; i < 70000; i++) {
+        const auto sequence = sent.push(0);
+        TEST_ASSERT_NOT_EQUAL(0, sequence);
+        TEST_ASSERT_TRUE(received.accept(sequence));
+        TEST_ASSERT_EQUAL(1, sent.acknowledge(received.cumulative(), received.selective()));
+    }
+    TEST_ASSERT_EQUAL(bpa::advanceSequence(1, 70000 % 65535, bpa::EXTENDED_SEQUENCE_LIMIT), sent.oldest());
+    TEST_ASSERT_FALSE(received.accept(sent.oldest() - 1));
+}
+
+void test_slidingWindow_tunnelAcknowledgesAfterLoss() {
+    connectToPeer();
+
+    uint8_t payload[] = {1, 2, 3};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    udp.mock_clearSentPackets(); // The first frame is lost
+
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    tunnel->flush();
+    deliver(udp, peerUdp);
+    peer->loop();
+    TEST_ASSERT_EQUAL(2, peerReceived.count);
+
+    uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+    const auto length = peerUdp.mock_getSentPacket(0, buffer, sizeof(buffer));
+    bpa::FrameBatchReader<BPA_UDP_CHECKSUM> reader(buffer, length);
+    bpa::BinaryMessage last = bpa::emptyMessage();
+    while (reader.next()) {
+        last = reader.message();
+    }
+    TEST_ASSERT_EQUAL(bpa::extendedStartByte(bpa::StartByte::ACKNOWLEDGE), last.start);
+    TEST_ASSERT_EQUAL(3, last.size);
+    TEST_ASSERT_EQUAL(0xFF, last.data[0]); // Nothing received in order
+    TEST_ASSERT_EQUAL(0xFF, last.data[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, last.data[2]);
+}
+
+void test_slidingWindow_tunnelRejectsWhenFull() {
+    connectToPeer();
+    tunnel->onError(countFull);
+    fullCount = 0;
+
+    uint8_t payload[] = {1, 2, 3};
+    for (int i = 0; i <= BPA_UDP_WINDOW_SIZE; i++) {
+        tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    }
+    TEST_ASSERT_EQUAL(1, fullCount);
+
+    exchange();
+    TEST_ASSERT_EQUAL(BPA_UDP_WINDOW_SIZE, peerReceived.count);
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(1, fullCount);
+}
@@ -0,0 +1,12 @@
+#ifndef TEST_SLIDING_WINDOW_H
+#define TEST_SLIDING_WINDOW_H
+
+void test_slidingWindow_cumulativeAndSelective();
+void test_slidingWindow_dropOldestFirst();
+void test_slidingWindow_receiverReportsGaps();
+void test_slidingWindow_sequenceSkipsZero();
+void test_slidingWindow_extendedSequenceWraps();
+void test_slidingWindow_tunnelAcknowledgesAfterLoss();
+void test_slidingWindow_tunnelRejectsWhenFull();
+
+#endif //TEST_SLIDING_WINDOW_H
@@ -0,0 +1,111 @@
+#include "test_timer_wheel.h"
+
+#include <unity.h>
+
+#include "TimerWheel.h"
+#include "tunnel_fixture.h"
+
+namespace {
+    using Wheel = bpa::TimerWheel<4, 8, 10>; ///< 8 slots of 10 ms, one rotation is 80 ms
+
+    uint8_t expiredKeys[4];  ///< The keys of the expired timers, in order
+    size_t expiredCount = 0; ///< The number of expired timers
+
+    Wheel sharedWheel;    ///< The wheel used by the callback of test_timerWheel_callbackRemovesAndReschedules
+    uint8_t removedTimer; ///< The timer removed by that callback
+
+    void recordExpired(uint8_t, uint8_t, const uint8_t key) {
+        expiredKeys[expiredCount++] = key;
+    }
+}
+
+void test_timerWheel_expiresOnlyDueTimers() {
+    Wheel wheel;
+    wheel.advance(1000, recordExpired);
+    expiredCount = 0;
+
+    wheel.add(0, 1, 1015);
+    wheel.add(0, 2, 1035);
+    wheel.add(0, 3, 1036);
+
+    TEST_ASSERT_EQUAL(0, wheel.advance(1014, recordExpired));
+    TEST_ASSERT_EQUAL(1, wheel.advance(1020, recordExpired));
+    TEST_ASSERT_EQUAL(1, wheel.advance(1035, recordExpired));
+    TEST_ASSERT_EQUAL(1, wheel.advance(1200, recordExpired));
+    TEST_ASSERT_EQUAL(3, expiredCount);
+    TEST_ASSERT_EQUAL(1, expiredKeys[0]);
+    TEST_ASSERT_EQUAL(2, expiredKeys[1]);
+    TEST_ASSERT_EQUAL(3, expiredKeys[2]);
+}
+
+void test_timerWheel_laterRotationStaysScheduled() {
+    Wheel wheel;
+    wheel.advance(1000, recordExpired);
+    expiredCount = 0;
+
+    // Shares the slot of 1005 but expires two rotations later
+    wheel.add(0, 7, 1165);
+    TEST_ASSERT_EQUAL(0, wheel.advance(1010, recordExpired));
+    TEST_ASSERT_EQUAL(0, wheel.advance(1090, recordExpired));
+    TEST_ASSERT_EQUAL(0, wheel.advance(1164, recordExpired));
+    TEST_ASSERT_EQUAL(1, wheel.advance(1166, recordExpired));
+    TEST_ASSERT_EQUAL(7, expiredKeys[0]);
+}
+
+void test_timerWheel_callbackRemovesAndReschedules() {
+    sharedWheel = Wheel();
+    sharedWheel.advance(1000, recordExpired);
+    expiredCount = 0;
+
+    sharedWheel.add(0, 1, 1005);
+    removedTimer = sharedWheel.add(0, 2, 1005);
+    sharedWheel.add(0, 3, 1005);
+
+    // The last added timer is visited first, it removes a timer of the same slot and reschedules itself
+    const auto count = sharedWheel.advance(1010, [](const uint8_t timer, uint8_t, const uint8_t key) {
+        expiredKeys[expiredCount++] = key;
+        if (key == 3) {
+            sharedWheel.remove(removedTimer);
+            sharedWheel.schedule(timer, 1050);
+        }
+    });
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL(3, expiredKeys[0]);
+    TEST_ASSERT_EQUAL(1, expiredKeys[1]);
+    TEST_ASSERT_EQUAL(1050, sharedWheel.nextExpiry(0));
+
+    TEST_ASSERT_EQUAL(1, sharedWheel.advance(1060, recordExpired));
+    TEST_ASSERT_EQUAL(3, expiredKeys[2]);
+}
+
+void test_timerWheel_nextExpiry() {
+    Wheel wheel;
+    TEST_ASSERT_EQUAL(5000, wheel.nextExpiry(5000));
+
+    wheel.advance(1000, recordExpired);
+    const auto timer = wheel.add(0, 1, 1300);
+    wheel.add(0, 2, 1200);
+    TEST_ASSERT_EQUAL(1200, wheel.nextExpiry(5000));
+
+    wheel.expireBy(timer, 1100);
+    TEST_ASSERT_EQUAL(1100, wheel.nextExpiry(5000));
+    wheel.expireBy(timer, 1250);
+    TEST_ASSERT_EQUAL(1100, wheel.deadline(timer));
+
+    wheel.remove(timer);
+    TEST_ASSERT_EQUAL(1200, wheel.nextExpiry(5000));
+}
+
+void test_timerWheel_tunnelSchedulesDeviceTimeouts() {
+    connectToPeer();
+
+    const auto now  = GET_CURRENT_TIMESTAMP();
+    const auto next = tunnel->nextExpiry();
+    TEST_ASSERT_TRUE(static_cast<long>(next - now) >= 0);
+    TEST_ASSERT_TRUE(next - now <= BPA_PING_FREQUENCY + 1);
+
+    // A frame in flight does not expire later than the lost packet timeout
+    uint8_t payload[] = {1, 2, 3};
+    tunnel->sendMessage(PEER_ID, payload, sizeof(payload));
+    TEST_ASSERT_TRUE(tunnel->nextExpiry() - now <= BPA_LOST_PACKET_TIMEOUT + 1);
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_TIMER_WHEEL_H
+#define TEST_TIMER_WHEEL_H
+
+void test_timerWheel_expiresOnlyDueTimers();
+void test_timerWheel_laterRotationStaysScheduled();
+void test_timerWheel_callbackRemovesAndReschedules();
+void test_timerWheel_nextExpiry();
+void test_timerWheel_tunnelSchedulesDeviceTimeouts();
+
+#endif //TEST_TIMER_WHEEL_H
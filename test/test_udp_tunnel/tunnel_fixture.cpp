@@ -0,0 +1,86 @@
+#include "tunnel_fixture.h"
+
+#include <unity.h>
+
+const IPAddress TUNNEL_IP(192, 168, 0, 1);
+const IPAddress PEER_IP(192, 168, 0, 2);
+
+ReceivedMessage peerReceived;
+
+namespace {
+    uint8_t deliveredToTunnel[8][BPA_UDP_MAX_DATAGRAM_SIZE];
+    uint8_t deliveredToPeer[8][BPA_UDP_MAX_DATAGRAM_SIZE];
+}
+
+size_t readSentFrames(const size_t index, uint8_t* buffer, bpa::BinaryMessage* messages, const size_t capacity)
+{
+    const auto length = udp.mock_getSentPacket(index, buffer, BPA_UDP_MAX_DATAGRAM_SIZE);
+    bpa::FrameBatchReader<BPA_UDP_CHECKSUM> reader(buffer, length);
+    size_t count = 0;
+    while (count < capacity && reader.next())
+    {
+        messages[count++] = reader.message();
+    }
+    return count;
+}
+
+size_t countSentFrames(const bpa::StartByte start)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < udp.mock_getSentPacketCount(); i++)
+    {
+        uint8_t buffer[BPA_UDP_MAX_DATAGRAM_SIZE];
+        bpa::BinaryMessage messages[16];
+        const auto frames = readSentFrames(i, buffer, messages, 16);
+        for (size_t j = 0; j < frames; j++)
+        {
+            count += bpa::basicStartByte(messages[j].start) == start ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+size_t deliver(MockUDP& from, MockUDP& to)
+{
+    auto storage = &to == &udp ? deliveredToTunnel : deliveredToPeer;
+    const auto count = from.mock_getSentPacketCount();
+    TEST_ASSERT_TRUE(count <= 8);
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto length = from.mock_getSentPacket(i, storage[i], BPA_UDP_MAX_DATAGRAM_SIZE);
+        to.mock_addPacketToParse(storage[i], length);
+    }
+    from.mock_clearSentPackets();
+    return count;
+}
+
+void exchange()
+{
+    for (int round = 0; round < 16; round++)
+    {
+        tunnel->loop();
+        const auto sent = deliver(udp, peerUdp);
+        peer->loop();
+        if (sent + deliver(peerUdp, udp) == 0)
+        {
+            return;
+        }
+    }
+    TEST_FAIL_MESSAGE("The tunnels did not settle");
+}
+
+void connectToPeer()
+{
+    tunnel->connect(PEER_IP, PORT);
+    exchange();
+    TEST_ASSERT_TRUE(tunnel->isConnected(PEER_ID));
+    TEST_ASSERT_TRUE(peer->isConnected(TUNNEL_ID));
+}
+
+void waitFor(const bpa::TimeStamp timeout)
+{
+    const auto start = GET_CURRENT_TIMESTAMP();
+    while (GET_CURRENT_TIMESTAMP() - start <= timeout + BPA_UDP_TIMER_RESOLUTION)
+    {
+    }
+}
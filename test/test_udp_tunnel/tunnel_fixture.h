@@ -0,0 +1,89 @@
+#ifndef TUNNEL_FIXTURE_H
+#define TUNNEL_FIXTURE_H
+
+#include <MockUdp.h>
+#include <UdpTunnel.h>
+
+#define TUNNEL_ID 0x01 ///< The device ID of the tunnel under test
+#define PEER_ID 0x02   ///< The device ID of the peer tunnel
+#define PORT 4210      ///< The port number of both tunnels
+
+extern MockUDP udp;     ///< The network of the tunnel under test
+extern MockUDP peerUdp; ///< The network of the peer tunnel
+
+extern bpa::udp::UDPTunnel* tunnel; ///< The tunnel under test
+extern bpa::udp::UDPTunnel* peer;   ///< The peer tunnel
+
+extern const IPAddress TUNNEL_IP; ///< The IP address of the tunnel under test
+extern const IPAddress PEER_IP;   ///< The IP address of the peer tunnel
+
+/**
+ * @brief The last message delivered to the onMessageReceived callback of the peer.
+ */
+struct ReceivedMessage {
+    size_t count;         ///< The number of delivered messages
+    bpa::DeviceID sender; ///< The sender of the last message
+    uint8_t data[BPA_MAX_MESSAGE_SIZE];
+    bpa::MessageSize size;
+};
+
+extern ReceivedMessage peerReceived;
+
+/**
+ * @brief Reads the frames of a datagram sent by the tunnel.
+ *
+ * @param index The index of the sent datagram.
+ * @param buffer Buffer receiving the datagram, the returned messages point into it.
+ * @param messages Array receiving the decoded messages.
+ * @param capacity The capacity of the messages array.
+ * @return The number of decoded messages.
+ */
+size_t readSentFrames(size_t index, uint8_t* buffer, bpa::BinaryMessage* messages, size_t capacity);
+
+/**
+ * @brief Counts the frames of the datagrams sent by the tunnel with the given start byte, basic or extended header.
+ */
+size_t countSentFrames(bpa::StartByte start);
+
+/**
+ * @brief Moves the datagrams sent through one network to the receive queue of the other one.
+ *
+ * @return The number of moved datagrams.
+ */
+size_t deliver(MockUDP& from, MockUDP& to);
+
+/**
+ * @brief Runs the loop of both tunnels until no datagram is exchanged anymore.
+ */
+void exchange();
+
+/**
+ * @brief Connects the tunnel under test to the peer.
+ */
+void connectToPeer();
+
+/**
+ * @brief Waits until a timeout of the given length has passed, plus the timer resolution of the tunnels.
+ */
+void waitFor(bpa::TimeStamp timeout);
+
+/**
+ * @brief Runs a step, e.g. exchange() followed by a check, until it returns true or the timeout passes.
+ *
+ * @return True if the step returned true.
+ */
+template<typename TStep>
+bool loopUntil(TStep&& step, const bpa::TimeStamp timeout)
+{
+    const auto start = GET_CURRENT_TIMESTAMP();
+    while (!step())
+    {
+        if (GET_CURRENT_TIMESTAMP() - start > timeout)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif //TUNNEL_FIXTURE_H